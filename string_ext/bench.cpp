@@ -0,0 +1,309 @@
+#include "string_ext.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <fstream>
+#include <new>
+
+/// Micro benchmarks of str::format against snprintf, hand written ostringstream code and raw std::string concatenation
+///
+/// g++ -std=c++14 -O2 bench.cpp -o bench && ./bench bench_output.txt
+///
+/// Writes one CSV row per case and implementation:
+///		family,case,impl,ns_per_call,allocs_per_call,bytes_per_call,mb_per_s
+///
+/// str::format returns a std::string, str::format_to and snprintf write into a stack buffer.
+/// The concat rows append std::to_string and literals to a std::string, they are left out of cases
+/// needing hex, octal, exponents, precision or padding which std::to_string cannot write
+
+/// Every heap allocation made while a benchmark runs is counted
+static size_t g_allocs = 0;
+
+void* operator new(size_t size) {
+	++g_allocs;
+	void *ptr = std::malloc(size != 0u ? size : 1u);
+	if (ptr == nullptr) throw std::bad_alloc();
+	return ptr;
+};
+void operator delete(void *ptr) noexcept { std::free(ptr); };
+void operator delete(void *ptr, size_t) noexcept { std::free(ptr); };
+
+/// Results are added up here so the calls cannot be optimized away
+static volatile size_t g_sink = 0;
+
+struct Result {
+	double ns, allocs, bytes;
+};
+
+/**
+ * Time a function returning the number of chars it produced
+ * @param func		The function to time
+ * @return			Returns the best of several runs, each long enough to be timed reliably
+ */
+template<typename Func>
+Result measure(Func func) {
+	typedef std::chrono::steady_clock Clock;
+
+	/// Find how many calls take at least 10ms
+	size_t iters = 16;
+	while (true) {
+		const Clock::time_point start = Clock::now();
+		for (size_t i = 0; i < iters; ++i) g_sink += func();
+		if (Clock::now() - start >= std::chrono::milliseconds(10) || iters >= (1u << 26)) break;
+		iters *= 2u;
+	}
+
+	double best = 1e300;
+	for (int run = 0; run < 5; ++run) {
+		const Clock::time_point start = Clock::now();
+		for (size_t i = 0; i < iters; ++i) g_sink += func();
+		best = std::min(best, std::chrono::duration<double, std::nano>(Clock::now() - start).count() / (double) iters);
+	}
+
+	const size_t allocs = g_allocs;
+	size_t bytes = 0;
+	for (size_t i = 0; i < iters; ++i) bytes += func();
+	const Result result = { best, (double) (g_allocs - allocs) / (double) iters, (double) bytes / (double) iters };
+	return result;
+};
+
+static FILE *g_out = stdout;
+
+void report(const char *family, const char *name, const char *impl, const Result &r) {
+	std::fprintf(g_out, "%s,%s,%s,%.1f,%.2f,%.0f,%.1f\n", family, name, impl, r.ns, r.allocs, r.bytes, r.bytes * 1e3 / r.ns);
+	std::fflush(g_out);
+};
+
+/// Cases raw concatenation cannot express pass nullptr and get no concat row
+void reportConcat(const char *family, const char *name, std::nullptr_t) {};
+template<typename Concat>
+void reportConcat(const char *family, const char *name, Concat concat) {
+	report(family, name, "concat", measure([&]() {
+		std::string s;
+		concat(s);
+		return s.size();
+	}));
+};
+
+/**
+ * Benchmark one case with each implementation
+ * @param family	Specifier family, d, f, s...
+ * @param name		Case name, must not contain a comma
+ * @param fmt		The str::format format string, passed along as a literal
+ * @param print		snprintf baseline, print(buf, size) returns the length
+ * @param stream	ostringstream baseline, stream(os) writes the same output to os
+ * @param concat	std::string baseline, concat(s) appends the same output to s, or nullptr
+ * @param ...args	The arguments to format
+ */
+template<size_t N, typename Print, typename Stream, typename Concat, typename ...Args>
+void bench(const char *family, const char *name, const char (&fmt)[N], Print print, Stream stream, Concat concat, const Args &...args) {
+	char buf[1024];
+	report(family, name, "str::format", measure([&]() { return str::format(fmt, args...).size(); }));
+	report(family, name, "str::format_to", measure([&]() { return (size_t) (str::format_to(buf, fmt, args...) - buf); }));
+	report(family, name, "snprintf", measure([&]() { return (size_t) print(buf, sizeof(buf)); }));
+	report(family, name, "ostringstream", measure([&]() {
+		std::ostringstream os;
+		stream(os);
+		return os.str().size();
+	}));
+	reportConcat(family, name, concat);
+};
+
+/// User type written by operator<<
+struct Streamed {
+	int x, y;
+};
+std::ostream& operator<<(std::ostream &os, const Streamed &v) { return os << '(' << v.x << ", " << v.y << ')'; };
+
+/// User type written by a str::formatter
+struct Formatted {
+	int x, y;
+};
+namespace str {
+	template<> struct formatter<Formatted> {
+		void format(writer &out, const Formatted &v) const { out.format("(%d, %d)", v.x, v.y); };
+	};
+};
+
+int main(int argc, char **argv) {
+	if (argc > 1) {
+		g_out = std::fopen(argv[1], "w");
+		if (g_out == nullptr) {
+			std::fprintf(stderr, "Cannot open '%s'\n", argv[1]);
+			return EXIT_FAILURE;
+		}
+	}
+	std::fprintf(g_out, "family,case,impl,ns_per_call,allocs_per_call,bytes_per_call,mb_per_s\n");
+
+	const int i = -123456789;
+	const unsigned int u = 3735928559u;
+	const long long ll = 9007199254740993LL;
+	const double d = 3.14159265358979;
+	const double big = 6.02214076e23;
+	const char *cs = "hello world";
+	const std::string str = "a std::string of a typical length";
+	void *ptr = (void*) &str;
+
+	/// d / x / o
+	bench("d", "int", "%d",
+		[&](char *b, size_t n) { return std::snprintf(b, n, "%d", i); },
+		[&](std::ostream &os) { os << i; },
+		[&](std::string &s) { s += std::to_string(i); }, i);
+	bench("d", "long long", "%d",
+		[&](char *b, size_t n) { return std::snprintf(b, n, "%lld", ll); },
+		[&](std::ostream &os) { os << ll; },
+		[&](std::string &s) { s += std::to_string(ll); }, ll);
+	bench("d", "flags width", "%+012d",
+		[&](char *b, size_t n) { return std::snprintf(b, n, "%+012d", i); },
+		[&](std::ostream &os) { os << std::showpos << std::internal << std::setfill('0') << std::setw(12) << i; },
+		nullptr, i);
+	bench("x", "hex", "%x",
+		[&](char *b, size_t n) { return std::snprintf(b, n, "%x", u); },
+		[&](std::ostream &os) { os << std::hex << u; },
+		nullptr, u);
+	bench("x", "hex prefix", "%#X",
+		[&](char *b, size_t n) { return std::snprintf(b, n, "%#X", u); },
+		[&](std::ostream &os) { os << std::hex << std::uppercase << std::showbase << u; },
+		nullptr, u);
+	bench("o", "octal", "%o",
+		[&](char *b, size_t n) { return std::snprintf(b, n, "%o", u); },
+		[&](std::ostream &os) { os << std::oct << u; },
+		nullptr, u);
+
+	/// f / e / g
+	bench("f", "fixed", "%f",
+		[&](char *b, size_t n) { return std::snprintf(b, n, "%f", d); },
+		[&](std::ostream &os) { os << std::fixed << d; },
+		[&](std::string &s) { s += std::to_string(d); }, d);
+	bench("f", "fixed precision", "%.3f",
+		[&](char *b, size_t n) { return std::snprintf(b, n, "%.3f", d); },
+		[&](std::ostream &os) { os << std::fixed << std::setprecision(3) << d; },
+		nullptr, d);
+	bench("e", "scientific", "%e",
+		[&](char *b, size_t n) { return std::snprintf(b, n, "%e", big); },
+		[&](std::ostream &os) { os << std::scientific << big; },
+		nullptr, big);
+	bench("g", "general", "%g",
+		[&](char *b, size_t n) { return std::snprintf(b, n, "%g", d); },
+		[&](std::ostream &os) { os << d; },
+		nullptr, d);
+	bench("g", "general precision", "%.17g",
+		[&](char *b, size_t n) { return std::snprintf(b, n, "%.17g", big); },
+		[&](std::ostream &os) { os << std::setprecision(17) << big; },
+		nullptr, big);
+
+	/// s
+	bench("s", "char*", "%s",
+		[&](char *b, size_t n) { return std::snprintf(b, n, "%s", cs); },
+		[&](std::ostream &os) { os << cs; },
+		[&](std::string &s) { s += cs; }, cs);
+	bench("s", "std::string", "%s",
+		[&](char *b, size_t n) { return std::snprintf(b, n, "%s", str.c_str()); },
+		[&](std::ostream &os) { os << str; },
+		[&](std::string &s) { s += str; }, str);
+	bench("s", "width precision", "%-20.5s",
+		[&](char *b, size_t n) { return std::snprintf(b, n, "%-20.5s", cs); },
+		[&](std::ostream &os) { os << std::left << std::setw(20) << std::string(cs, 5); },
+		nullptr, cs);
+	bench("s", "operator<< type", "%s",
+		[&](char *b, size_t n) { return std::snprintf(b, n, "(%d, %d)", 10, 20); },
+		[&](std::ostream &os) { os << Streamed{ 10, 20 }; },
+		[&](std::string &s) { s += '('; s += std::to_string(10); s += ", "; s += std::to_string(20); s += ')'; }, Streamed{ 10, 20 });
+	bench("s", "str::formatter type", "%s",
+		[&](char *b, size_t n) { return std::snprintf(b, n, "(%d, %d)", 10, 20); },
+		[&](std::ostream &os) { os << '(' << 10 << ", " << 20 << ')'; },
+		[&](std::string &s) { s += '('; s += std::to_string(10); s += ", "; s += std::to_string(20); s += ')'; }, Formatted{ 10, 20 });
+
+	/// c / p / b
+	bench("c", "char", "%c",
+		[&](char *b, size_t n) { return std::snprintf(b, n, "%c", 'x'); },
+		[&](std::ostream &os) { os << 'x'; },
+		[&](std::string &s) { s += 'x'; }, 'x');
+	bench("p", "pointer", "%p",
+		[&](char *b, size_t n) { return std::snprintf(b, n, "%p", ptr); },
+		[&](std::ostream &os) { os << ptr; },
+		nullptr, ptr);
+	bench("b", "bool", "%b",
+		[&](char *b, size_t n) { return std::snprintf(b, n, "%d", 1); },
+		[&](std::ostream &os) { os << true; },
+		[&](std::string &s) { s += std::to_string(1); }, true);
+
+	/// Arity
+	bench("arity", "1 arg", "id=%d",
+		[&](char *b, size_t n) { return std::snprintf(b, n, "id=%d", i); },
+		[&](std::ostream &os) { os << "id=" << i; },
+		[&](std::string &s) { s += "id="; s += std::to_string(i); }, i);
+	bench("arity", "2 args", "id=%d name=%s",
+		[&](char *b, size_t n) { return std::snprintf(b, n, "id=%d name=%s", i, cs); },
+		[&](std::ostream &os) { os << "id=" << i << " name=" << cs; },
+		[&](std::string &s) { s += "id="; s += std::to_string(i); s += " name="; s += cs; }, i, cs);
+	bench("arity", "3 args", "id=%d name=%s value=%.2f",
+		[&](char *b, size_t n) { return std::snprintf(b, n, "id=%d name=%s value=%.2f", i, cs, d); },
+		[&](std::ostream &os) { os << "id=" << i << " name=" << cs << " value=" << std::fixed << std::setprecision(2) << d; },
+		nullptr, i, cs, d);
+	bench("arity", "10 args", "%d %u %x %s %s %c %.2f %e %g %d",
+		[&](char *b, size_t n) { return std::snprintf(b, n, "%d %u %x %s %s %c %.2f %e %g %lld", i, u, u, cs, str.c_str(), 'z', d, big, d, ll); },
+		[&](std::ostream &os) {
+			os << i << ' ' << u << ' ' << std::hex << u << std::dec << ' ' << cs << ' ' << str << ' ' << 'z' << ' '
+			   << std::fixed << std::setprecision(2) << d << ' ' << std::scientific << std::setprecision(6) << big << ' ';
+			os.unsetf(std::ios::floatfield);
+			os << d << ' ' << ll;
+		},
+		nullptr, i, u, u, cs, str, 'z', d, big, d, ll);
+	bench("arity", "16 args", "%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d",
+		[&](char *b, size_t n) { return std::snprintf(b, n, "%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d,%d",
+			1, 22, 333, 4444, 55555, 666666, 7777777, 88888888, 1, 22, 333, 4444, 55555, 666666, 7777777, 88888888); },
+		[&](std::ostream &os) {
+			os << 1 << ',' << 22 << ',' << 333 << ',' << 4444 << ',' << 55555 << ',' << 666666 << ',' << 7777777 << ',' << 88888888 << ','
+			   << 1 << ',' << 22 << ',' << 333 << ',' << 4444 << ',' << 55555 << ',' << 666666 << ',' << 7777777 << ',' << 88888888; },
+		[&](std::string &s) {
+			const int vals[] = { 1, 22, 333, 4444, 55555, 666666, 7777777, 88888888, 1, 22, 333, 4444, 55555, 666666, 7777777, 88888888 };
+			for (int v = 0; v < 16; ++v) {
+				if (v != 0) s += ',';
+				s += std::to_string(vals[v]);
+			} },
+		1, 22, 333, 4444, 55555, 666666, 7777777, 88888888, 1, 22, 333, 4444, 55555, 666666, 7777777, 88888888);
+
+	/// '*' width and precision
+	bench("star", "width", "%*d",
+		[&](char *b, size_t n) { return std::snprintf(b, n, "%*d", 15, i); },
+		[&](std::ostream &os) { os << std::setw(15) << i; },
+		nullptr, 15, i);
+	bench("star", "precision", "%.*f",
+		[&](char *b, size_t n) { return std::snprintf(b, n, "%.*f", 4, d); },
+		[&](std::ostream &os) { os << std::fixed << std::setprecision(4) << d; },
+		nullptr, 4, d);
+	bench("star", "width precision", "%*.*f",
+		[&](char *b, size_t n) { return std::snprintf(b, n, "%*.*f", 12, 4, d); },
+		[&](std::ostream &os) { os << std::fixed << std::setw(12) << std::setprecision(4) << d; },
+		nullptr, 12, 4, d);
+
+	/// Literal segments
+	bench("literal", "short", "[%d]",
+		[&](char *b, size_t n) { return std::snprintf(b, n, "[%d]", i); },
+		[&](std::ostream &os) { os << '[' << i << ']'; },
+		[&](std::string &s) { s += '['; s += std::to_string(i); s += ']'; }, i);
+	bench("literal", "long",
+		"The quick brown fox jumps over the lazy dog while the request with id %d is being processed by the worker pool "
+		"and the result is %s after a long wait in the queue behind many other requests",
+		[&](char *b, size_t n) { return std::snprintf(b, n,
+			"The quick brown fox jumps over the lazy dog while the request with id %d is being processed by the worker pool "
+			"and the result is %s after a long wait in the queue behind many other requests", i, cs); },
+		[&](std::ostream &os) {
+			os << "The quick brown fox jumps over the lazy dog while the request with id " << i << " is being processed by the worker pool "
+			   << "and the result is " << cs << " after a long wait in the queue behind many other requests"; },
+		[&](std::string &s) {
+			s += "The quick brown fox jumps over the lazy dog while the request with id ";
+			s += std::to_string(i);
+			s += " is being processed by the worker pool and the result is ";
+			s += cs;
+			s += " after a long wait in the queue behind many other requests"; }, i, cs);
+	bench("literal", "no args", "a format string with no declarations",
+		[&](char *b, size_t n) { return std::snprintf(b, n, "a format string with no declarations"); },
+		[&](std::ostream &os) { os << "a format string with no declarations"; },
+		[&](std::string &s) { s += "a format string with no declarations"; });
+
+	if (g_out != stdout) std::fclose(g_out);
+	return (g_sink == 0u) ? EXIT_FAILURE : EXIT_SUCCESS;
+};
@@ -32,8 +32,120 @@ SOFTWARE.
 #include <typeinfo>
 #include <algorithm>
 #include <ios>
+#include <locale>
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <climits>
+#include <limits>
+#include <tuple>
+#include <utility>
+#include <type_traits>
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <functional>
+#include <cstddef>
+#include <array>
+#include <iterator>
+#include <initializer_list>
+#include <exception>
+
+/// Compile-time format strings need relaxed constexpr (C++14)
+#if (defined(_MSVC_LANG) ? _MSVC_LANG : __cplusplus) >= 201402L
+#define STR_EXT_CPP14
+#endif
+
+/// std::string_view arguments (C++17)
+#if (defined(_MSVC_LANG) ? _MSVC_LANG : __cplusplus) >= 201703L
+#define STR_EXT_CPP17
+#include <string_view>
+#if defined(__has_include)
+#if __has_include(<charconv>)
+#include <charconv>
+#endif
+#endif
+#endif
+
+/// Format strings as template arguments, str::static_format<"...">(args...) (C++20)
+#if defined(STR_EXT_CPP17) && defined(__cpp_nontype_template_args) && __cpp_nontype_template_args >= 201911L
+#define STR_EXT_CPP20
+#endif
+
+/// SIMD kernels for the binary encoding specifiers, chosen at runtime with a scalar fallback (x86 GCC, Clang and MSVC)
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define STR_EXT_X86
+#define STR_EXT_TARGET(isa) __attribute__((target(isa)))
+#include <immintrin.h>
+#elif (defined(_M_X64) || defined(_M_IX86)) && defined(_MSC_VER)
+#define STR_EXT_X86
+#define STR_EXT_TARGET(isa)
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+/// Printing straight to file descriptors, scatter-gather and memory mapped output (POSIX)
+#if defined(__unix__) || defined(__APPLE__)
+#define STR_EXT_POSIX
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <sys/mman.h>
+#include <cerrno>
+#endif
 
 namespace str { /// Main namespace
+
+	/// Specialize to control how a type is written by '%s', see the public interface below
+	template<typename T, typename Enable = void>
+	struct formatter;
+
+	/// Fixed capacity string built at compile time by str::static_format, see the public interface below
+	template<size_t N>
+	struct static_string;
+
+	/// A pointer and length of raw bytes for the binary encoding specifiers, '%h' / '%H' (hex) and '%m' (base64)
+	struct bytes {
+		const void *data;
+		size_t size;
+
+		bytes(const void *data, const size_t size) : data(data), size(size) {};
+	};
+
+	/// Outcome of str::scan, converts to true when the whole format string was matched
+	struct scan_result {
+		enum error_type {
+			ok,				/// Every declaration was matched and assigned
+			mismatch,		/// The input did not match a literal part of the format string
+			invalid,		/// The input could not be read as the declaration's type
+			out_of_range,	/// A number did not fit its argument, or text did not fit a char array
+			end_of_input	/// The input ended before the format string
+		};
+
+		error_type error;
+		size_t count;		/// Arguments assigned before scanning stopped
+		size_t pos;			/// Chars of input consumed, on error where in the input it happened
+
+		scan_result() : error(ok), count(0u), pos(0u) {};
+
+		explicit operator bool() const { return error == ok; };
+
+		const char* what() const {
+			switch (error) {
+			case ok:			return "ok";
+			case mismatch:		return "input does not match the format";
+			case invalid:		return "invalid value";
+			case out_of_range:	return "value out of range";
+			default:			return "unexpected end of input";
+			}
+		};
+	};
+
 	namespace imp { /// Implementation namespace
 		
 		/// Print line info for debugging
@@ -43,12 +155,12 @@ namespace str { /// Main namespace
 		};
 
 		/// Check if string contains specifier
-		inline bool _containsChar(const char specifier, const std::string &str) {
-			return std::find(str.begin(), str.end(), specifier) != str.end();
+		inline constexpr bool _containsChar(const char specifier, const char *str) {
+			return (*str != '\0') && ((*str == specifier) || _containsChar(specifier, str + 1));
 		};
 
-		inline char* _findChar(char *fmtS, char *fmtE, char delim) {
-			for (char *pos = fmtS; pos != fmtE; ++pos) {
+		inline const char* _findChar(const char *fmtS, const char *fmtE, const char delim) {
+			for (const char *pos = fmtS; pos != fmtE; ++pos) {
 				if (*pos == delim) return pos;
 			}
 			return fmtE;
@@ -69,160 +181,848 @@ namespace str { /// Main namespace
 			return std::string(1, specifier);
 		};
 
-		/// Get the valid specifiers for a given type
-		inline std::string _specString(int &val)						
-		{ return "d, i, o, x, X, n"; };
-		inline std::string _specString(short int &val)					
-		{ return "d, i, o, x, X, n"; };
-		inline std::string _specString(long int &val)					
-		{ return "d, i, o, x, X, n"; };
-		inline std::string _specString(long long int &val)				
-		{ return "d, i, o, x, X, n"; };
-		inline std::string _specString(unsigned int &val)				
-		{ return "u, o, x, X, n"; };
-		inline std::string _specString(unsigned short int &val)			
-		{ return "u, o, x, X, n"; };
-		inline std::string _specString(unsigned long int &val)			
-		{ return "u, o, x, X, n"; };
-		inline std::string _specString(unsigned long long int &val)		
-		{ return "u, o, x, X, n"; };
-		inline std::string _specString(float &val)						
-		{ return "f, e, E, g, G"; };
-		inline std::string _specString(double &val)						
-		{ return "f, e, E, g, G"; };
-		inline std::string _specString(long double &val)				
-		{ return "f, e, E, g, G"; };
-		inline std::string _specString(std::string &val)				
-		{ return "s"; };
-		template<typename T>
-		inline std::string _specString(T &val)							
-		{ return "s"; };
-		inline std::string _specString(char &val)						
-		{ return "c"; };
-		inline std::string _specString(unsigned char &val)						
-		{ return "c"; };
-		template<typename T> 
-		inline std::string _specString(T *&val)							
-		{ return "p"; };
-		inline std::string _specString(bool &val)						
-		{ return "b, B"; };
-
-		inline std::string _specString(const int &val)						
-		{ return "d, i, o, x, X"; };
-		inline std::string _specString(const short int &val)					
-		{ return "d, i, o, x, X"; };
-		inline std::string _specString(const long int &val)					
-		{ return "d, i, o, x, X"; };
-		inline std::string _specString(const long long int &val)				
-		{ return "d, i, o, x, X"; };
-		inline std::string _specString(const unsigned int &val)				
-		{ return "u, o, x, X"; };
-		inline std::string _specString(const unsigned short int &val)			
-		{ return "u, o, x, X"; };
-		inline std::string _specString(const unsigned long int &val)			
-		{ return "u, o, x, X"; };
-		inline std::string _specString(const unsigned long long int &val)		
-		{ return "u, o, x, X"; };
-		inline std::string _specString(const float &val)						
-		{ return "f, e, E, g, G"; };
-		inline std::string _specString(const double &val)						
-		{ return "f, e, E, g, G"; };
-		inline std::string _specString(const long double &val)				
-		{ return "f, e, E, g, G"; };
-		inline std::string _specString(const std::string &val)				
-		{ return "s"; };
-		template<typename T>
-		inline std::string _specString(const T &val)							
-		{ return "s"; };
-		inline std::string _specString(const char &val)						
-		{ return "c"; };
-		inline std::string _specString(const unsigned char &val)						
-		{ return "c"; };
-		template<typename T>
-		inline std::string _specString(const T *&val)							
-		{ return "p"; };
-		inline std::string _specString(const bool &val)						
-		{ return "b, B"; };
-
-		/// Check if the given type matches the given specifier
-		inline bool _checkVal(const char specifier, int &val)						
-		{ return _containsChar(specifier, "dioxXn"); };
-		inline bool _checkVal(const char specifier, short int &val)					
-		{ return _containsChar(specifier, "dioxXn"); };
-		inline bool _checkVal(const char specifier, long int &val)					
-		{ return _containsChar(specifier, "dioxXn"); };
-		inline bool _checkVal(const char specifier, long long int &val)				
-		{ return _containsChar(specifier, "dioxXn"); };
-		inline bool _checkVal(const char specifier, unsigned int &val)				
-		{ return _containsChar(specifier, "uoxXn"); };
-		inline bool _checkVal(const char specifier, unsigned short int &val)		
-		{ return _containsChar(specifier, "uoxXn"); };
-		inline bool _checkVal(const char specifier, unsigned long int &val)			
-		{ return _containsChar(specifier, "uoxXn"); };
-		inline bool _checkVal(const char specifier, unsigned long long int &val)	
-		{ return _containsChar(specifier, "uoxXn"); };
-		inline bool _checkVal(const char specifier, float &val)						
-		{ return _containsChar(specifier, "feEgG"); };
-		inline bool _checkVal(const char specifier, double &val)					
-		{ return _containsChar(specifier, "feEgG"); };
-		inline bool _checkVal(const char specifier, long double &val)				
-		{ return _containsChar(specifier, "feEgG"); };
-		inline bool _checkVal(const char specifier, std::string &val)				
-		{ return specifier == 's'; };
-		
-		inline bool _checkVal(const char specifier, char &val)						
-		{ return specifier == 'c'; };
-		inline bool _checkVal(const char specifier, unsigned char &val)						
-		{ return specifier == 'c'; };
-		
-		inline bool _checkVal(const char specifier, bool &val)						
-		{ return _containsChar(specifier, "bB"); };
-
-		inline bool _checkVal(const char specifier, const int &val)						
-		{ return _containsChar(specifier, "dioxX"); };
-		inline bool _checkVal(const char specifier, const short int &val)					
-		{ return _containsChar(specifier, "dioxX"); };
-		inline bool _checkVal(const char specifier, const long int &val)					
-		{ return _containsChar(specifier, "dioxX"); };
-		inline bool _checkVal(const char specifier, const long long int &val)				
-		{ return _containsChar(specifier, "dioxX"); };
-		inline bool _checkVal(const char specifier, const unsigned int &val)				
-		{ return _containsChar(specifier, "uoxX"); };
-		inline bool _checkVal(const char specifier, const unsigned short int &val)		
-		{ return _containsChar(specifier, "uoxX"); };
-		inline bool _checkVal(const char specifier, const unsigned long int &val)			
-		{ return _containsChar(specifier, "uoxX"); };
-		inline bool _checkVal(const char specifier, const unsigned long long int &val)	
-		{ return _containsChar(specifier, "uoxX"); };
-		inline bool _checkVal(const char specifier, const float &val)						
-		{ return _containsChar(specifier, "feEgG"); };
-		inline bool _checkVal(const char specifier, const double &val)					
-		{ return _containsChar(specifier, "feEgG"); };
-		inline bool _checkVal(const char specifier, const long double &val)				
-		{ return _containsChar(specifier, "feEgG"); };
-		inline bool _checkVal(const char specifier, const std::string &val)				
-		{ return specifier == 's'; };
-		
-		inline bool _checkVal(const char specifier, const char &val)						
-		{ return specifier == 'c'; };
-		inline bool _checkVal(const char specifier, const unsigned char &val)						
-		{ return specifier == 'c'; };
-		
-		inline bool _checkVal(const char specifier, const bool &val)						
-		{ return _containsChar(specifier, "bB"); };
+		/**
+		* Output buffer which formatting writes into. Subclasses provide the storage and decide what 
+		* happens when it fills up, either growing the storage, flushing it somewhere else, or discarding.
+		*/
+		class _Buffer {
+		public:
+			inline void push_back(const char c) {
+				if (_size < _capacity)	_ptr[_size++] = c;
+				else					_overflow(&c, 1u);
+			};
 
-		template<class T>
-		inline bool _checkVal(const char specifier, T &val)							
-		{ return specifier == 's'; };
-		template<typename T>
-		inline bool _checkVal(const char specifier, T *&val)						
-		{ return specifier == 'p'; };
-		template<class T>
-		inline bool _checkVal(const char specifier, const T &val)							
-		{ return specifier == 's'; };
-		template<typename T>
-		inline bool _checkVal(const char specifier, const T *&val)						
-		{ return specifier == 'p'; };
+			inline void append(const char *s, const size_t n) {
+				if (n <= _capacity - _size) {
+					std::memcpy(_ptr + _size, s, n);
+					_size += n;
+				}
+				else {
+					_overflow(s, n);
+				}
+			};
+
+			inline void fill(const char c, const size_t n) {
+				if (n <= _capacity - _size) {
+					std::memset(_ptr + _size, c, n);
+					_size += n;
+				}
+				else {
+					_overflowFill(c, n);
+				}
+			};
+
+			/// Number of chars currently held by the buffer
+			inline size_t size() const { return _size; };
+			inline const char* data() const { return _ptr; };
+
+			/// Number of chars written to the buffer in total, including any which have been flushed or discarded
+			inline size_t written() const { return _flushed + _size; };
+
+		protected:
+			_Buffer(char *ptr, const size_t capacity) : _ptr(ptr), _size(0), _capacity(capacity), _flushed(0) {};
+			virtual ~_Buffer() {};
+
+			/// Called when the buffer is full, must make room for at least one more char and should make room for n total
+			virtual void _grow(const size_t n) = 0;
+
+			/// Called when n chars do not fit in the remaining capacity
+			virtual void _overflow(const char *s, size_t n) {
+				while (n > 0) {
+					if (_size == _capacity) _grow(_size + n);
+					const size_t count = std::min(n, _capacity - _size);
+					std::memcpy(_ptr + _size, s, count);
+					_size += count;
+					s += count;
+					n -= count;
+				}
+			};
+
+			virtual void _overflowFill(const char c, size_t n) {
+				while (n > 0) {
+					if (_size == _capacity) _grow(_size + n);
+					const size_t count = std::min(n, _capacity - _size);
+					std::memset(_ptr + _size, c, count);
+					_size += count;
+					n -= count;
+				}
+			};
+
+			char *_ptr;
+			size_t _size, _capacity;
+			size_t _flushed;	/// Chars which have left the buffer
+
+		private:
+			_Buffer(const _Buffer&);
+			_Buffer& operator=(const _Buffer&);
+		};
+
+		/// Buffer with inline storage for N chars which spills to a heap allocated std::string when it fills up
+		template<size_t N = 500>
+		class _MemoryBuffer : public _Buffer {
+		public:
+			_MemoryBuffer() : _Buffer(_store, N) {};
+
+			/// Take the result as a string, when the buffer spilled the heap storage is moved out rather than copied
+			inline std::string str() {
+				if (_ptr == _store) return std::string(_store, _size);
+				_heap.resize(_size);
+				_ptr = _store;
+				_capacity = N;
+				_size = 0;
+				return std::move(_heap);
+			};
+
+		protected:
+			virtual void _grow(const size_t n) override {
+				const size_t capacity = std::max(n, _capacity + (_capacity / 2u));
+				if (_ptr == _store) {
+					_heap.resize(capacity);
+					std::memcpy(&(_heap[0]), _store, _size);
+				}
+				else {
+					_heap.resize(capacity);
+				}
+				_ptr = &(_heap[0]);
+				_capacity = _heap.size();
+			};
+
+		private:
+			char _store[N];
+			std::string _heap;
+		};
+
+		/// Buffer which appends to the end of a std::string in chunks, reusing whatever capacity it already has
+		class _StringBuffer : public _Buffer {
+		public:
+			explicit _StringBuffer(std::string &out) : _Buffer(_store, sizeof(_store)), _out(out) {};
+
+			/// Append anything still held to the string
+			inline void flush() { _grow(0u); };
+
+		protected:
+			virtual void _grow(const size_t n) override {
+				_out.append(_ptr, _size);
+				_flushed += _size;
+				_size = 0;
+			};
+
+			/// Large writes go straight to the string rather than through the chunk
+			virtual void _overflow(const char *s, const size_t n) override {
+				_grow(0u);
+				_out.append(s, n);
+				_flushed += n;
+			};
+
+			virtual void _overflowFill(const char c, const size_t n) override {
+				_grow(0u);
+				_out.append(n, c);
+				_flushed += n;
+			};
+
+		private:
+			char _store[256];
+			std::string &_out;
+		};
+
+#ifdef STR_EXT_THREAD_BUFFER
+		/// Scratch storage kept alive between calls on each thread, only one call may hold it at a time
+		struct _ThreadScratch {
+			std::string data;
+			bool inUse;
+		};
+
+		inline _ThreadScratch& _threadScratch() {
+			static thread_local _ThreadScratch scratch = { std::string(), false };
+			return scratch;
+		};
+
+		/// Buffer which writes into the thread's scratch storage, which only ever grows so steady state formatting never allocates
+		class _ThreadBuffer : public _Buffer {
+		public:
+			explicit _ThreadBuffer(_ThreadScratch &scratch) : _Buffer(nullptr, 0u), _scratch(scratch) {
+				_scratch.inUse = true;
+				if (_scratch.data.empty()) _scratch.data.resize(500u);
+				_ptr = &(_scratch.data[0]);
+				_capacity = _scratch.data.size();
+			};
+
+			virtual ~_ThreadBuffer() { _scratch.inUse = false; };
+
+			/// Copy the result out with a single exactly sized allocation
+			inline std::string str() const { return std::string(_ptr, _size); };
+
+		protected:
+			virtual void _grow(const size_t n) override {
+				_scratch.data.resize(std::max(n, _capacity + (_capacity / 2u)));
+				_ptr = &(_scratch.data[0]);
+				_capacity = _scratch.data.size();
+			};
+
+		private:
+			_ThreadScratch &_scratch;
+		};
+#endif
+
+		/// Run func on the cheapest buffer available to this thread and take its output as a string
+		template<typename Func>
+		inline std::string _formatToString(Func &&func) {
+#ifdef STR_EXT_THREAD_BUFFER
+			/// Nested calls, from operator<< or a str::formatter, fall back to the stack while the scratch is held
+			_ThreadScratch &scratch = _threadScratch();
+			if (!scratch.inUse) {
+				_ThreadBuffer ret(scratch);
+				func(static_cast<_Buffer&>(ret));
+				return ret.str();
+			}
+#endif
+			_MemoryBuffer<> ret;
+			func(static_cast<_Buffer&>(ret));
+			return ret.str();
+		};
+
+		/// Buffer which writes to an output iterator in chunks
+		template<typename OutputIt>
+		class _IteratorBuffer : public _Buffer {
+		public:
+			explicit _IteratorBuffer(OutputIt out) : _Buffer(_store, sizeof(_store)), _out(out) {};
+
+			/// Flush and get the iterator past the last char written
+			inline OutputIt out() {
+				_grow(0u);
+				return _out;
+			};
+
+		protected:
+			virtual void _grow(const size_t n) override {
+				_out = std::copy(_ptr, _ptr + _size, _out);
+				_flushed += _size;
+				_size = 0;
+			};
+
+		private:
+			char _store[256];
+			OutputIt _out;
+		};
+
+		/// Buffer which writes straight through to a char pointer, the caller guarantees there is enough room
+		template<>
+		class _IteratorBuffer<char*> : public _Buffer {
+		public:
+			explicit _IteratorBuffer(char *out) : _Buffer(out, ((size_t) -1) / 2u) {};
+
+			inline char* out() const { return _ptr + _size; };
+
+		protected:
+			virtual void _grow(const size_t n) override {};
+		};
+
+		/// Buffer which writes at most limit chars to an output iterator, everything after that is only counted
+		template<typename OutputIt>
+		class _TruncatingBuffer : public _Buffer {
+		public:
+			_TruncatingBuffer(OutputIt out, const size_t limit) : _Buffer(_store, sizeof(_store)), _out(out), _limit(limit) {};
+
+			/// Flush and get the iterator past the last char written
+			inline OutputIt out() {
+				_grow(0u);
+				return _out;
+			};
+
+		protected:
+			virtual void _grow(const size_t n) override {
+				_write(_ptr, _size);
+				_size = 0;
+			};
+
+			virtual void _overflow(const char *s, const size_t n) override {
+				_grow(0u);
+				_write(s, n);
+			};
+
+			virtual void _overflowFill(const char c, size_t n) override {
+				_grow(0u);
+				while (n > 0 && _flushed < _limit) {
+					const size_t count = std::min(n, sizeof(_store));
+					std::memset(_store, c, count);
+					_write(_store, count);
+					n -= count;
+				}
+				_flushed += n;
+			};
+
+		private:
+			/// Write up to the limit and count the rest
+			inline void _write(const char *s, const size_t n) {
+				const size_t count = (_flushed < _limit) ? std::min(n, _limit - _flushed) : 0u;
+				_out = std::copy(s, s + count, _out);
+				_flushed += n;
+			};
+
+			char _store[256];
+			OutputIt _out;
+			size_t _limit;
+		};
+
+		/// Buffer which writes at most limit chars straight through to a char pointer, everything after that is only counted
+		template<>
+		class _TruncatingBuffer<char*> : public _Buffer {
+		public:
+			_TruncatingBuffer(char *out, const size_t limit) : _Buffer(out, limit), _out(out), _limit(limit) {};
+
+			inline char* out() const { return _out + std::min(written(), _limit); };
+
+		protected:
+			/// Only reached when the output is full, from then on chars are just counted
+			virtual void _grow(const size_t n) override {
+				_flushed += _size;
+				_ptr = _store;
+				_capacity = sizeof(_store);
+				_size = 0;
+			};
+
+			virtual void _overflow(const char *s, const size_t n) override {
+				const size_t count = std::min(n, _capacity - _size);
+				std::memcpy(_ptr + _size, s, count);
+				_size += count;
+				_grow(0u);
+				_flushed += n - count;
+			};
+
+			virtual void _overflowFill(const char c, const size_t n) override {
+				const size_t count = std::min(n, _capacity - _size);
+				std::memset(_ptr + _size, c, count);
+				_size += count;
+				_grow(0u);
+				_flushed += n - count;
+			};
+
+		private:
+			char _store[64];
+			char *_out;
+			size_t _limit;
+		};
+
+		/// Buffer which only counts the chars written to it
+		class _CountingBuffer : public _Buffer {
+		public:
+			_CountingBuffer() : _Buffer(_store, sizeof(_store)) {};
+
+		protected:
+			virtual void _grow(const size_t n) override {
+				_flushed += _size;
+				_size = 0;
+			};
+
+			virtual void _overflow(const char *s, const size_t n) override {
+				_flushed += _size + n;
+				_size = 0;
+			};
+
+			virtual void _overflowFill(const char c, const size_t n) override {
+				_flushed += _size + n;
+				_size = 0;
+			};
+
+		private:
+			char _store[64];
+		};
+
+		/// Buffer which collects output on the stack and passes it on a chunk at a time, so memory stays constant however long the output
+		class _SinkBuffer : public _Buffer {
+		public:
+			/// Pass on whatever is still held
+			/// @return			Returns false if any of the output failed to reach the destination
+			inline bool flush() {
+				_grow(0u);
+				return _ok;
+			};
+
+		protected:
+			_SinkBuffer(char *store, const size_t capacity) : _Buffer(store, capacity), _store(store), _ok(true) {};
+
+			/// Write n chars to the destination, returns false on failure after which nothing more is written
+			virtual bool _write(const char *s, const size_t n) = 0;
+
+			virtual void _grow(const size_t n) override {
+				if (_ok && _size > 0u) _ok = _write(_ptr, _size);
+				_flushed += _size;
+				_size = 0;
+			};
+
+			/// Writes too large for the buffer go straight to the destination rather than being copied through it
+			virtual void _overflow(const char *s, const size_t n) override {
+				_grow(0u);
+				if (n < _capacity) {
+					std::memcpy(_store, s, n);
+					_size = n;
+					return;
+				}
+				if (_ok) _ok = _write(s, n);
+				_flushed += n;
+			};
+
+		private:
+			char *_store;
+			bool _ok;
+		};
+
+		/// Buffer which writes to a std::streambuf, the caller holds an ostream::sentry
+		class _StreamSinkBuffer : public _SinkBuffer {
+		public:
+			explicit _StreamSinkBuffer(std::streambuf &buf) : _SinkBuffer(_store, sizeof(_store)), _buf(buf) {};
+
+		protected:
+			virtual bool _write(const char *s, const size_t n) override {
+				return _buf.sputn(s, (std::streamsize) n) == (std::streamsize) n;
+			};
+
+		private:
+			char _store[1024];
+			std::streambuf &_buf;
+		};
+
+		/// Buffer which writes to a FILE*, the caller holds the file's lock
+		class _FileSinkBuffer : public _SinkBuffer {
+		public:
+			explicit _FileSinkBuffer(FILE *file) : _SinkBuffer(_store, sizeof(_store)), _file(file) {};
+
+		protected:
+			virtual bool _write(const char *s, const size_t n) override {
+				return std::fwrite(s, 1u, n, _file) == n;
+			};
+
+		private:
+			char _store[1024];
+			FILE *_file;
+		};
+
+#ifdef STR_EXT_POSIX
+		/// Buffer which writes to a file descriptor, sized so lines up to PIPE_BUF go out in one write and are not interleaved
+		class _FdSinkBuffer : public _SinkBuffer {
+		public:
+			explicit _FdSinkBuffer(const int fd) : _SinkBuffer(_store, sizeof(_store)), _fd(fd) {};
+
+		protected:
+			virtual bool _write(const char *s, size_t n) override {
+				while (n > 0u) {
+					const ssize_t count = ::write(_fd, s, n);
+					if (count < 0) {
+						if (errno == EINTR) continue;
+						return false;
+					}
+					s += count;
+					n -= (size_t) count;
+				}
+				return true;
+			};
+
+		private:
+			char _store[4096];
+			int _fd;
+		};
+
+		/// One piece of scatter-gather output, ptr is nullptr for the next size chars of the side buffer
+		struct _IovecPiece {
+			const char *ptr;
+			size_t size;
+		};
+
+		/// Buffer which references long literal segments of the format string and writes everything else to a side buffer
+		class _IovecBuffer : public _Buffer {
+		public:
+			/// Literals shorter than this are copied, an iovec costs more than copying a few chars
+			static const size_t _minReference = 64u;
+
+			_IovecBuffer(std::unique_ptr<char[]> &side, size_t &sideCapacity, std::vector<_IovecPiece> &pieces) :
+				_Buffer(side.get(), sideCapacity), _side(side), _sideCapacity(sideCapacity), _pieces(pieces), _mark(0u) {
+				/// A new message has no side buffer yet, and even empty writes must not be given a null pointer
+				if (_capacity == 0u) _grow(0u);
+				_pieces.clear();
+			};
+
+			/// Literal text which outlives the output, referenced rather than copied when long enough
+			inline void literal(const char *s, const size_t n) {
+				if (n < _minReference) {
+					append(s, n);
+					return;
+				}
+				_close();
+				_IovecPiece piece = { s, n };
+				_pieces.push_back(piece);
+				_flushed += n;
+			};
+
+			/// Point the iovecs at the literals and the side buffer, which has stopped moving
+			inline void finish(std::vector<struct iovec> &iov) {
+				_close();
+				iov.resize(_pieces.size());
+				size_t offset = 0u;
+				for (size_t i = 0; i < _pieces.size(); ++i) {
+					const char *ptr = _pieces[i].ptr;
+					if (ptr == nullptr) {
+						ptr = _ptr + offset;
+						offset += _pieces[i].size;
+					}
+					iov[i].iov_base = const_cast<char*>(ptr);
+					iov[i].iov_len = _pieces[i].size;
+				}
+			};
+
+		protected:
+			virtual void _grow(const size_t n) override {
+				const size_t capacity = std::max(std::max(n, _capacity + (_capacity / 2u)), (size_t) 256u);
+				std::unique_ptr<char[]> side(new char[capacity]);
+				if (_size > 0u) std::memcpy(side.get(), _ptr, _size);
+				_side = std::move(side);
+				_sideCapacity = capacity;
+				_ptr = _side.get();
+				_capacity = capacity;
+			};
+
+		private:
+			/// End the side buffer piece written since the last literal
+			inline void _close() {
+				if (_size == _mark) return;
+				_IovecPiece piece = { nullptr, _size - _mark };
+				_pieces.push_back(piece);
+				_mark = _size;
+			};
+
+			std::unique_ptr<char[]> &_side;
+			size_t &_sideCapacity;
+			std::vector<_IovecPiece> &_pieces;
+			size_t _mark;
+		};
+
+		/**
+		* Buffer which formats straight into a file through a window mapped over its end. When the window fills the file
+		* is extended by ftruncate and the next window mapped, so only one window of address space is ever used.
+		* If the file can not be extended the rest of the output is dropped.
+		*/
+		class _MappedBuffer : public _Buffer {
+		public:
+			_MappedBuffer(const char *path, const size_t step) :
+				_Buffer(_scratch, sizeof(_scratch)), _fd(-1), _window(nullptr), _ok(false), _length(0u) {
+				const size_t page = (size_t) sysconf(_SC_PAGESIZE);
+				_step = std::max((step + page - 1u) / page, (size_t) 1u) * page;
+				_fd = ::open(path, O_RDWR | O_CREAT | O_TRUNC, 0666);
+				_ok = (_fd >= 0) && _mapWindow(0u, 0u);
+			};
+
+			~_MappedBuffer() { close(); };
+
+			/// False once closed, or if output has been dropped
+			inline bool ok() const { return _ok && _fd >= 0; };
+
+			/// Unmap the window and trim the file to the chars written
+			inline bool close() {
+				if (_fd < 0) return _ok;
+				if (_ok) _length = written();
+				_unmap();
+				if (::ftruncate(_fd, (off_t) _length) != 0) _ok = false;
+				if (::close(_fd) != 0) _ok = false;
+				_fd = -1;
+				_ptr = _scratch;
+				_capacity = sizeof(_scratch);
+				_size = 0;
+				return _ok;
+			};
+
+		protected:
+			virtual void _grow(const size_t n) override {
+				if (_ok) {
+					/// Start the next window at the page holding the current position, keeping the chars already written to it
+					const size_t pos = written();
+					const size_t offset = pos - (pos % (size_t) sysconf(_SC_PAGESIZE));
+					_unmap();
+					if (_mapWindow(offset, pos - offset)) return;
+					_ok = false;
+					_length = pos;
+					_ptr = _scratch;
+					_capacity = sizeof(_scratch);
+				}
+				/// Drop output after a failure
+				_size = 0;
+			};
+
+		private:
+			/// Extend the file and map a window of _step chars starting at offset, the first keep chars of which are already written
+			inline bool _mapWindow(const size_t offset, const size_t keep) {
+				if (::ftruncate(_fd, (off_t) (offset + _step)) != 0) return false;
+				void *map = ::mmap(nullptr, _step, PROT_READ | PROT_WRITE, MAP_SHARED, _fd, (off_t) offset);
+				if (map == MAP_FAILED) return false;
+				::madvise(map, _step, MADV_SEQUENTIAL);
+				_window = static_cast<char*>(map);
+				_ptr = _window;
+				_capacity = _step;
+				_size = keep;
+				_flushed = offset;
+				return true;
+			};
+
+			inline void _unmap() {
+				if (_window == nullptr) return;
+				::munmap(_window, _step);
+				_window = nullptr;
+			};
+
+			int _fd;
+			char *_window;
+			size_t _step;
+			bool _ok;
+			size_t _length;		/// Chars written before a failure
+			char _scratch[256];
+		};
+#endif
+
+		/// Buffer which forwards at most limit chars to another buffer, everything after that is only counted
+		class _LimitBuffer : public _Buffer {
+		public:
+			_LimitBuffer(_Buffer &out, const size_t limit) : _Buffer(_store, sizeof(_store)), _out(out), _limit(limit) {};
+
+			/// Forward anything still held to the other buffer
+			inline void flush() { _grow(0u); };
+
+		protected:
+			virtual void _grow(const size_t n) override {
+				_write(_ptr, _size);
+				_size = 0;
+			};
+
+			virtual void _overflow(const char *s, const size_t n) override {
+				_grow(0u);
+				_write(s, n);
+			};
+
+			virtual void _overflowFill(const char c, const size_t n) override {
+				_grow(0u);
+				if (_flushed < _limit) _out.fill(c, std::min(n, _limit - _flushed));
+				_flushed += n;
+			};
+
+		private:
+			/// Write up to the limit and count the rest
+			inline void _write(const char *s, const size_t n) {
+				if (_flushed < _limit) _out.append(s, std::min(n, _limit - _flushed));
+				_flushed += n;
+			};
+
+			char _store[128];
+			_Buffer &_out;
+			size_t _limit;
+		};
+
+		/// std::streambuf which writes ostream<< output straight into a _Buffer
+		class _BufferStreambuf : public std::streambuf {
+		public:
+			explicit _BufferStreambuf(_Buffer &ret) : _ret(ret) {
+				setp(_store, _store + sizeof(_store));
+			};
+
+			~_BufferStreambuf() { sync(); };
+
+		protected:
+			virtual int_type overflow(int_type c) override {
+				sync();
+				if (traits_type::eq_int_type(c, traits_type::eof())) return traits_type::not_eof(c);
+				*pptr() = traits_type::to_char_type(c);
+				pbump(1);
+				return c;
+			};
+
+			virtual std::streamsize xsputn(const char *s, std::streamsize n) override {
+				sync();
+				_ret.append(s, (size_t) n);
+				return n;
+			};
+
+			virtual int sync() override {
+				_ret.append(pbase(), (size_t) (pptr() - pbase()));
+				setp(_store, _store + sizeof(_store));
+				return 0;
+			};
+
+		private:
+			_Buffer &_ret;
+			char _store[128];
+		};
+
+#ifdef STR_EXT_C_LOCALE
+		/// Stream imbued with the classic locale once per thread, so ostream<< never copies the global locale
+		struct _ClassicStream {
+			std::ostream os;
+			bool inUse;
+
+			_ClassicStream() : os(nullptr), inUse(false) { os.imbue(std::locale::classic()); };
+		};
+
+		inline _ClassicStream& _classicStream() {
+			static thread_local _ClassicStream classic;
+			return classic;
+		};
+
+		/// Holds the thread's classic stream writing into buf, reset to the formatting state of a new stream
+		class _ClassicStreamLock {
+		public:
+			_ClassicStreamLock(_ClassicStream &classic, std::streambuf &buf) : _classic(classic) {
+				_classic.inUse = true;
+				std::ostream &os = _classic.os;
+				os.rdbuf(&buf);
+				os.flags(std::ios_base::skipws | std::ios_base::dec);
+				os.width(0);
+				os.precision(6);
+				os.fill(' ');
+			};
+
+			~_ClassicStreamLock() {
+				_classic.os.rdbuf(nullptr);
+				_classic.inUse = false;
+			};
+
+		private:
+			_ClassicStreamLock(const _ClassicStreamLock&);
+			_ClassicStreamLock& operator=(const _ClassicStreamLock&);
+
+			_ClassicStream &_classic;
+		};
+#endif
+
+		/// Output handle given to str::formatter<T>::format, writes straight into the buffer being formatted into
+		class _Writer {
+		public:
+			explicit _Writer(_Buffer &ret) : _ret(ret) {};
+
+			inline void push_back(const char c) { _ret.push_back(c); };
+			inline void append(const char *s, const size_t n) { _ret.append(s, n); };
+			inline void append(const char *s) { _ret.append(s, std::strlen(s)); };
+			inline void append(const std::string &s) { _ret.append(s.data(), s.size()); };
+			inline void fill(const char c, const size_t n) { _ret.fill(c, n); };
+
+			/// Stream val with ostream<< without building a temporary string
+			template<typename T>
+			inline void stream(const T &val) {
+				_BufferStreambuf buf(_ret);
+#ifdef STR_EXT_C_LOCALE
+				/// Nested calls, from inside an operator<<, get a stream of their own while the thread's is held
+				_ClassicStream &classic = _classicStream();
+				if (!classic.inUse) {
+					_ClassicStreamLock lock(classic, buf);
+					classic.os << val;
+					return;
+				}
+				std::ostream os(&buf);
+				os.imbue(std::locale::classic());
+#else
+				std::ostream os(&buf);
+#endif
+				os << val;
+			};
+
+			/// Format a nested format string straight into the output, either a string or wrapped by fmt_lit("...")
+			template<typename Fmt, typename ...Args>
+			inline void format(const Fmt &fmt, Args &&...args);
+
+			/// The underlying buffer
+			inline _Buffer& buffer() { return _ret; };
+
+		private:
+			_Buffer &_ret;
+		};
+
+		/// Element types of byte containers, which are written by '%h', '%H' and '%m' rather than '%s'
+		template<typename T> struct _IsByte							{ static const bool value = false; };
+		template<> struct _IsByte<char>								{ static const bool value = true; };
+		template<> struct _IsByte<signed char>						{ static const bool value = true; };
+		template<> struct _IsByte<unsigned char>					{ static const bool value = true; };
+#ifdef STR_EXT_CPP17
+		template<> struct _IsByte<std::byte>						{ static const bool value = true; };
+#endif
+		template<typename T> struct _IsBytes						{ static const bool value = false; };
+		template<> struct _IsBytes<bytes>							{ static const bool value = true; };
+		template<typename B, typename A> struct _IsBytes<std::vector<B, A>>	{ static const bool value = _IsByte<B>::value; };
+		template<typename B, size_t N> struct _IsBytes<std::array<B, N>>	{ static const bool value = _IsByte<B>::value; };
+		template<size_t N> struct _IsBytes<unsigned char[N]>		{ static const bool value = true; };
+		template<size_t N> struct _IsBytes<signed char[N]>			{ static const bool value = true; };
+#ifdef STR_EXT_CPP17
+		template<size_t N> struct _IsBytes<std::byte[N]>			{ static const bool value = true; };
+#endif
+		template<typename T> struct _IsBytes<const T>				{ static const bool value = _IsBytes<T>::value; };
+
+		/// The valid specifiers for a given type, anything without a specialization is printed with ostream<<
+		template<typename T> struct _Spec							{ static constexpr const char* chars() { return _IsBytes<T>::value ? "hHm" : "s"; }; };
+		template<typename T> struct _Spec<T*>						{ static constexpr const char* chars() { return "p"; }; };
+		template<typename T> struct _Spec<T* const>					{ static constexpr const char* chars() { return "p"; }; };
+		template<> struct _Spec<char*>								{ static constexpr const char* chars() { return "sphHm"; }; };
+		template<> struct _Spec<const char*>						{ static constexpr const char* chars() { return "sphHm"; }; };
+		template<> struct _Spec<char* const>						{ static constexpr const char* chars() { return "sphHm"; }; };
+		template<> struct _Spec<const char* const>					{ static constexpr const char* chars() { return "sphHm"; }; };
+		template<> struct _Spec<void*>								{ static constexpr const char* chars() { return "phHm"; }; };
+		template<> struct _Spec<const void*>						{ static constexpr const char* chars() { return "phHm"; }; };
+		template<> struct _Spec<void* const>						{ static constexpr const char* chars() { return "phHm"; }; };
+		template<> struct _Spec<const void* const>					{ static constexpr const char* chars() { return "phHm"; }; };
+		template<> struct _Spec<unsigned char*>						{ static constexpr const char* chars() { return "phHm"; }; };
+		template<> struct _Spec<const unsigned char*>				{ static constexpr const char* chars() { return "phHm"; }; };
+		template<> struct _Spec<unsigned char* const>				{ static constexpr const char* chars() { return "phHm"; }; };
+		template<> struct _Spec<const unsigned char* const>			{ static constexpr const char* chars() { return "phHm"; }; };
+		template<> struct _Spec<std::string>						{ static constexpr const char* chars() { return "shHm"; }; };
+		template<> struct _Spec<const std::string>					{ static constexpr const char* chars() { return "shHm"; }; };
+		template<size_t N> struct _Spec<char[N]>					{ static constexpr const char* chars() { return "shHm"; }; };
+		template<size_t N> struct _Spec<const char[N]>				{ static constexpr const char* chars() { return "shHm"; }; };
+#ifdef STR_EXT_CPP17
+		template<> struct _Spec<std::string_view>					{ static constexpr const char* chars() { return "shHm"; }; };
+		template<> struct _Spec<const std::string_view>				{ static constexpr const char* chars() { return "shHm"; }; };
+#endif
+		template<> struct _Spec<int>								{ static constexpr const char* chars() { return "dioxXn"; }; };
+		template<> struct _Spec<short int>							{ static constexpr const char* chars() { return "dioxXn"; }; };
+		template<> struct _Spec<long int>							{ static constexpr const char* chars() { return "dioxXn"; }; };
+		template<> struct _Spec<long long int>						{ static constexpr const char* chars() { return "dioxXn"; }; };
+		template<> struct _Spec<unsigned int>						{ static constexpr const char* chars() { return "uoxXn"; }; };
+		template<> struct _Spec<unsigned short int>					{ static constexpr const char* chars() { return "uoxXn"; }; };
+		template<> struct _Spec<unsigned long int>					{ static constexpr const char* chars() { return "uoxXn"; }; };
+		template<> struct _Spec<unsigned long long int>				{ static constexpr const char* chars() { return "uoxXn"; }; };
+		template<> struct _Spec<const int>							{ static constexpr const char* chars() { return "dioxX"; }; };
+		template<> struct _Spec<const short int>					{ static constexpr const char* chars() { return "dioxX"; }; };
+		template<> struct _Spec<const long int>						{ static constexpr const char* chars() { return "dioxX"; }; };
+		template<> struct _Spec<const long long int>				{ static constexpr const char* chars() { return "dioxX"; }; };
+		template<> struct _Spec<const unsigned int>					{ static constexpr const char* chars() { return "uoxX"; }; };
+		template<> struct _Spec<const unsigned short int>			{ static constexpr const char* chars() { return "uoxX"; }; };
+		template<> struct _Spec<const unsigned long int>			{ static constexpr const char* chars() { return "uoxX"; }; };
+		template<> struct _Spec<const unsigned long long int>		{ static constexpr const char* chars() { return "uoxX"; }; };
+		template<> struct _Spec<float>								{ static constexpr const char* chars() { return "feEgG"; }; };
+		template<> struct _Spec<double>								{ static constexpr const char* chars() { return "feEgG"; }; };
+		template<> struct _Spec<long double>						{ static constexpr const char* chars() { return "feEgG"; }; };
+		template<> struct _Spec<const float>						{ static constexpr const char* chars() { return "feEgG"; }; };
+		template<> struct _Spec<const double>						{ static constexpr const char* chars() { return "feEgG"; }; };
+		template<> struct _Spec<const long double>					{ static constexpr const char* chars() { return "feEgG"; }; };
+		template<> struct _Spec<char>								{ static constexpr const char* chars() { return "c"; }; };
+		template<> struct _Spec<unsigned char>						{ static constexpr const char* chars() { return "c"; }; };
+		template<> struct _Spec<const char>							{ static constexpr const char* chars() { return "c"; }; };
+		template<> struct _Spec<const unsigned char>				{ static constexpr const char* chars() { return "c"; }; };
+		template<> struct _Spec<bool>								{ static constexpr const char* chars() { return "bB"; }; };
+		template<> struct _Spec<const bool>							{ static constexpr const char* chars() { return "bB"; }; };
+
+		/// List the valid specifiers for a type given its _Spec<T>::chars()
+		inline std::string _specString(const char *specs) {
+			std::string ret;
+			for (const char *spec = specs; *spec != '\0'; ++spec) {
+				if (!ret.empty()) ret += ", ";
+				ret += *spec;
+			}
+			return ret;
+		};
+
+		/// Types which can be given as a '*' width or precision argument
+		template<typename T> struct _IsSizeArg						{ static const bool value = false; };
+		template<typename T> struct _IsSizeArg<const T>				{ static const bool value = _IsSizeArg<T>::value; };
+		template<> struct _IsSizeArg<int>							{ static const bool value = true; };
+		template<> struct _IsSizeArg<short int>						{ static const bool value = true; };
+		template<> struct _IsSizeArg<long int>						{ static const bool value = true; };
+		template<> struct _IsSizeArg<long long int>					{ static const bool value = true; };
+		template<> struct _IsSizeArg<unsigned int>					{ static const bool value = true; };
+		template<> struct _IsSizeArg<unsigned short int>			{ static const bool value = true; };
+		template<> struct _IsSizeArg<unsigned long int>				{ static const bool value = true; };
+		template<> struct _IsSizeArg<unsigned long long int>		{ static const bool value = true; };
 
 		inline int _widthArg(const int _line_, const char *_file_, int &arg) 
 		{ return (int) arg; };
@@ -313,12 +1113,46 @@ namespace str { /// Main namespace
 			char specifier;
 			bool leftJustify, forceSignSpace, forceSign, forceLong, padZeros;
 			int width, precision;
-			_Format() : specifier(0),
+			constexpr _Format() : specifier(0),
 				leftJustify(false), forceSignSpace(false), forceSign(false),
 				forceLong(false), padZeros(false),
 				width(-2), precision(-2) {};
 		};
 
+		/// Apply a '*' width argument, like printf a negative width is taken as left justification
+		inline void _setWidth(_Format &f, const int width) {
+			if (width < 0) {
+				f.leftJustify = true;
+				f.width = (width == INT_MIN) ? INT_MAX : -width;
+			}
+			else {
+				f.width = width;
+			}
+		};
+
+		/// Apply a '*' precision argument, like printf a negative precision is taken as no precision
+		inline void _setPrecision(_Format &f, const int precision) {
+			f.precision = (precision < 0) ? -2 : precision;
+		};
+
+		/// ASCII digits only, std::isdigit would consult the C locale
+		inline bool _isDigit(const char c) { return c >= '0' && c <= '9'; };
+
+		/// Convert a run of digits to an int, a width or precision past INT_MAX is an error
+		inline int _parseInt(const int _line_, const char *_file_, const char *s, const char *e) {
+			int val = 0;
+			for (const char *d = s; d != e; ++d) {
+				const int digit = *d - '0';
+				if (val > (INT_MAX - digit) / 10) {
+					_printDebug(_line_, _file_);
+					std::cerr << "String Format | Width or precision out of range: '" << std::string(s, e) << '\'' << std::endl << std::endl;
+					std::exit(EXIT_FAILURE);
+				}
+				val = (val * 10) + digit;
+			}
+			return val;
+		};
+
 		/**
 		* Munches a format declaration starting at pos, assuming *pos == '%'
 		* @param _line_		Pass along the debug macro __LINE__ from the call site
@@ -328,8 +1162,8 @@ namespace str { /// Main namespace
 		* @return			Returns a _Format object representing the munched format declaration
 		*/
 		inline _Format _parseFormat(const int _line_, const char *_file_,
-			char *&pos,
-			char *&fmtE) {
+			const char *&pos,
+			const char *fmtE) {
 
 			_Format fmt;
 			/// Assume pos starts on '%'
@@ -377,9 +1211,9 @@ namespace str { /// Main namespace
 					}
 					else {
 						auto n = pos;
-						while (n != fmtE && std::isdigit(*n)) n++;
+						while (n != fmtE && _isDigit(*n)) n++;
 						if (n != pos) {
-							fmt.width = std::stoi(std::string(pos, n));
+							fmt.width = _parseInt(_line_, _file_, pos, n);
 							pos = n - 1;
 						}
 						else {
@@ -392,16 +1226,20 @@ namespace str { /// Main namespace
 				else if (mode == 2) {
 					/// Precision
 					if (*pos == '.') {
-						/// Munch number
-						pos++;
+						/// Munch number, formats given as a view need not be null terminated
+						if (++pos == fmtE) {
+							_printDebug(_line_, _file_);
+							std::cerr << "String Format | Incomplete format string: Ended in '.'" << std::endl << std::endl;
+							std::exit(EXIT_FAILURE);
+						}
 						if (*pos == '*') {
 							fmt.precision = -1; // Special case: Precision will be given by the preceding argument
 						}
 						else {
 							auto n = pos;
-							while (n != fmtE && std::isdigit(*n)) n++;
+							while (n != fmtE && _isDigit(*n)) n++;
 							if (n != pos) {
-								fmt.precision = std::stoi(std::string(pos, n));
+								fmt.precision = _parseInt(_line_, _file_, pos, n);
 								pos = n - 1;
 							}
 							else {
@@ -425,7 +1263,7 @@ namespace str { /// Main namespace
 			}
 
 			/// Check for invalid specifier
-			if (!_containsChar(fmt.specifier, "diuoxXnfeEgGaAscpbB")) {
+			if (!_containsChar(fmt.specifier, "diuoxXnfeEgGaAscpbBhHm")) {
 				_printDebug(_line_, _file_);
 				std::cerr << "String Format | Undefined format specifier: '"
 						  << _escape(fmt.specifier) << '\'' << std::endl << std::endl;
@@ -434,490 +1272,5197 @@ namespace str { /// Main namespace
 			return fmt;
 		};
 
-		/// Attempt to format a bool
+		/// Report a _formatXXX function being called with a type it cannot format, unreachable after typechecking
 		template<typename T>
-		inline void _formatBool(const int _line_, const char *_file_,
-			std::ostringstream &ret,
-			const _Format &f,
-			T &&val) {
+		inline void _formatError(const int _line_, const char *_file_, const char *func, const T &val) {
 			_printDebug(_line_, _file_);
-			std::cerr << "String Format | _formatBool called with (" << typeid(val).name() << ")" << std::endl << std::endl;
+			std::cerr << "String Format | " << func << " called with (" << typeid(val).name() << ")" << std::endl << std::endl;
 			std::exit(EXIT_FAILURE);
 		};
-		inline void _formatBool(const int _line_, const char *_file_,
-			std::ostringstream &ret,
-			const _Format &f,
-			bool &&val) {
 
-			switch (f.specifier) {
-			case 'b':
-				if (f.forceLong) {
-					ret << (val ? "true" : "false");
-				}
-				else {
-					ret << (val ? '1' : '0');
-				}
-				break;
-			case 'B':
-				if (f.forceLong) {
-					ret << (val ? "TRUE" : "FALSE");
-				}
-				else {
-					ret << (val ? 'T' : 'F');
-				}
-				break;
+		/**
+		* Write a formatted value applying width, justification and padding
+		* @param ret		The buffer to write output to
+		* @param f			The _Format struct representing how to display the value
+		* @param prefix		Sign and base prefix, zero padding is inserted after the prefix
+		* @param prefixLen	Length of prefix
+		* @param body		The digits or text of the value
+		* @param bodyLen	Length of body
+		* @param zeros		Zeros written between the prefix and body regardless of width (integer precision)
+		* @param numeric	Whether zero padding goes between the prefix and body rather than before everything
+		*/
+		inline void _writeField(_Buffer &ret, const _Format &f,
+			const char *prefix, const size_t prefixLen,
+			const char *body, const size_t bodyLen,
+			const size_t zeros, const bool numeric) {
+
+			const size_t len = prefixLen + zeros + bodyLen;
+			const size_t padding = (f.width > 0 && (size_t) f.width > len) ? ((size_t) f.width - len) : 0u;
+
+			if (f.leftJustify) {
+				ret.append(prefix, prefixLen);
+				ret.fill('0', zeros);
+				ret.append(body, bodyLen);
+				ret.fill(' ', padding);
+			}
+			else if (f.padZeros && numeric) {
+				ret.append(prefix, prefixLen);
+				ret.fill('0', zeros + padding);
+				ret.append(body, bodyLen);
+			}
+			else {
+				ret.fill(f.padZeros ? '0' : ' ', padding);
+				ret.append(prefix, prefixLen);
+				ret.fill('0', zeros);
+				ret.append(body, bodyLen);
 			}
 		};
-		inline void _formatBool(const int _line_, const char *_file_,
-			std::ostringstream &ret,
-			const _Format &f,
-			const bool &&val) {
 
-			switch (f.specifier) {
-			case 'b':
-				if (f.forceLong) {
-					ret << (val ? "true" : "false");
-				}
-				else {
-					ret << (val ? '1' : '0');
-				}
-				break;
-			case 'B':
-				if (f.forceLong) {
-					ret << (val ? "TRUE" : "FALSE");
-				}
-				else {
-					ret << (val ? 'T' : 'F');
-				}
-				break;
-			}
+		/// Write text applying width and justification
+		inline void _writeField(_Buffer &ret, const _Format &f, const char *body, const size_t bodyLen) {
+			_writeField(ret, f, "", 0u, body, bodyLen, 0u, false);
 		};
 
-		/// Attempt to print any pointer type as a hexidecimal size_t
-		template<typename T>
-		inline void _formatPtr(const int _line_, const char *_file_,
-			std::ostringstream &ret,
-			const _Format &f,
-			T &&val) {
-			_printDebug(_line_, _file_);
-			std::cerr << "String Format | _formatPtr called with (" << typeid(val).name() << ")" << std::endl << std::endl;
-			std::exit(EXIT_FAILURE);
+		/// Pairs of decimal digits for 0-99
+		inline const char* _decimalPairs() {
+			static const char table[] =
+				"0001020304050607080910111213141516171819"
+				"2021222324252627282930313233343536373839"
+				"4041424344454647484950515253545556575859"
+				"6061626364656667686970717273747576777879"
+				"8081828384858687888990919293949596979899";
+			return table;
 		};
-		template<typename T>
-		inline void _formatPtr(const int _line_, const char *_file_,
-			std::ostringstream &ret,
-			const _Format &f,
-			T *&&val) {
 
-			ret << std::showbase << std::hex;
-			size_t *ptr = (size_t*) (&val);
-			ret << *ptr;
+		/// Pairs of hex digits for each byte
+		inline const char* _hexPairs(const bool upper) {
+			static const char lower[] =
+				"000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f"
+				"202122232425262728292a2b2c2d2e2f303132333435363738393a3b3c3d3e3f"
+				"404142434445464748494a4b4c4d4e4f505152535455565758595a5b5c5d5e5f"
+				"606162636465666768696a6b6c6d6e6f707172737475767778797a7b7c7d7e7f"
+				"808182838485868788898a8b8c8d8e8f909192939495969798999a9b9c9d9e9f"
+				"a0a1a2a3a4a5a6a7a8a9aaabacadaeafb0b1b2b3b4b5b6b7b8b9babbbcbdbebf"
+				"c0c1c2c3c4c5c6c7c8c9cacbcccdcecfd0d1d2d3d4d5d6d7d8d9dadbdcdddedf"
+				"e0e1e2e3e4e5e6e7e8e9eaebecedeeeff0f1f2f3f4f5f6f7f8f9fafbfcfdfeff";
+			static const char upperTable[] =
+				"000102030405060708090A0B0C0D0E0F101112131415161718191A1B1C1D1E1F"
+				"202122232425262728292A2B2C2D2E2F303132333435363738393A3B3C3D3E3F"
+				"404142434445464748494A4B4C4D4E4F505152535455565758595A5B5C5D5E5F"
+				"606162636465666768696A6B6C6D6E6F707172737475767778797A7B7C7D7E7F"
+				"808182838485868788898A8B8C8D8E8F909192939495969798999A9B9C9D9E9F"
+				"A0A1A2A3A4A5A6A7A8A9AAABACADAEAFB0B1B2B3B4B5B6B7B8B9BABBBCBDBEBF"
+				"C0C1C2C3C4C5C6C7C8C9CACBCCCDCECFD0D1D2D3D4D5D6D7D8D9DADBDCDDDEDF"
+				"E0E1E2E3E4E5E6E7E8E9EAEBECEDEEEFF0F1F2F3F4F5F6F7F8F9FAFBFCFDFEFF";
+			return upper ? upperTable : lower;
 		};
 
-		/// Attempt to format anything with an ostream<< operator, namely std::string
+		/// Pairs of octal digits for each 6 bits
+		inline const char* _octalPairs() {
+			static const char table[] =
+				"00010203040506071011121314151617"
+				"20212223242526273031323334353637"
+				"40414243444546475051525354555657"
+				"60616263646566677071727374757677";
+			return table;
+		};
+
+		/// Powers of ten from 10^0 to 10^19
+		inline const unsigned long long* _powersOf10() {
+			static const unsigned long long table[] = {
+				1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull, 100000000ull, 1000000000ull,
+				10000000000ull, 100000000000ull, 1000000000000ull, 10000000000000ull, 100000000000000ull,
+				1000000000000000ull, 10000000000000000ull, 100000000000000000ull, 1000000000000000000ull, 10000000000000000000ull
+			};
+			return table;
+		};
+
+		/// Number of decimal digits in val, 0 has no digits
+		inline unsigned int _countDigits(const unsigned long long val) {
+			const unsigned long long *powers = _powersOf10();
+#if defined(__GNUC__) || defined(__clang__)
+			/// log10 from the bit length, then correct by one with a single compare
+			const unsigned int t = ((64u - (unsigned int) __builtin_clzll(val | 1u)) * 1233u) >> 12;
+			return t + 1u - (unsigned int) (val < powers[t]);
+#else
+			unsigned int count = 0;
+			while (count < 20u && val >= powers[count]) ++count;
+			return count;
+#endif
+		};
+
+		/// Write the decimal digits of val backwards ending at end, two digits at a time
 		template<typename T>
-		inline void _formatString(const int _line_, const char *_file_,
-			std::ostringstream &ret,
-			const _Format &f,
-			T &&val) {
-			
-			std::ostringstream ss;
-			ss << val;
-			const std::string s = ss.str();
-			if (f.precision == 0 || f.precision >= (int) s.size()) {
-				ret << s;
+		inline void _writeDecimal(char *end, T val) {
+			const char *pairs = _decimalPairs();
+			while (val >= 100u) {
+				const size_t idx = (size_t) (val % 100u) * 2u;
+				val /= 100u;
+				end -= 2;
+				end[0] = pairs[idx];
+				end[1] = pairs[idx + 1u];
+			}
+			if (val >= 10u) {
+				end[-2] = pairs[(size_t) val * 2u];
+				end[-1] = pairs[(size_t) val * 2u + 1u];
+			}
+			else if (val > 0u) {
+				end[-1] = (char) ('0' + val);
+			}
+		};
+
+		/**
+		* Write the digits of val backwards ending at end for a power of two base, two digits at a time
+		* @param end		One past where the last digit goes
+		* @param val		The value to write
+		* @param pairs		Table of digit pairs for each (1 << (bits * 2)) values
+		* @param bits		Bits per digit, 3 for octal and 4 for hex
+		* @return			Pointer to the first digit
+		*/
+		inline char* _writePow2(char *end, unsigned long long val, const char *pairs, const unsigned int bits) {
+			const unsigned long long base = 1ull << bits, mask = (base * base) - 1u;
+			while (val >= base * base) {
+				const size_t idx = (size_t) (val & mask) * 2u;
+				val >>= bits * 2u;
+				end -= 2;
+				end[0] = pairs[idx];
+				end[1] = pairs[idx + 1u];
+			}
+			if (val >= base) {
+				end -= 2;
+				end[0] = pairs[(size_t) val * 2u];
+				end[1] = pairs[(size_t) val * 2u + 1u];
+			}
+			else if (val > 0u) {
+				*(--end) = pairs[(size_t) val * 2u + 1u];
+			}
+			return end;
+		};
+
+		/**
+		* Format an integer from its sign and magnitude
+		* @param ret		The buffer to write output to
+		* @param f			The _Format struct representing how to display the value
+		* @param negative	Whether the value is negative, only ever true for 'd' and 'i'
+		* @param val		The magnitude of the value
+		*/
+		inline void _formatInteger(_Buffer &ret, const _Format &f, const bool negative, unsigned long long val) {
+			const unsigned int base = (f.specifier == 'o') ? 8u : ((f.specifier == 'x' || f.specifier == 'X') ? 16u : 10u);
+
+			/// Digits are generated backwards from the end of the buffer
+			char buf[24];
+			char *end = buf + sizeof(buf), *pos = end;
+			if (base == 10u) {
+				pos = end - _countDigits(val);
+				if (val <= 0xFFFFFFFFull)	_writeDecimal(end, (unsigned int) val);
+				else						_writeDecimal(end, val);
+			}
+			else if (base == 16u) {
+				pos = _writePow2(end, val, _hexPairs(f.specifier == 'X'), 4u);
 			}
 			else {
-				ret << s.substr(0, f.precision);
+				pos = _writePow2(end, val, _octalPairs(), 3u);
+			}
+			const size_t len = (size_t) (end - pos);
+
+			char prefix[2];
+			size_t prefixLen = 0;
+			if (negative)								prefix[prefixLen++] = '-';
+			else if (f.forceSign && base == 10u && f.specifier != 'u') prefix[prefixLen++] = '+';
+			if (f.forceLong && base == 16u && len > 0) {
+				prefix[prefixLen++] = '0';
+				prefix[prefixLen++] = f.specifier;
 			}
+
+			/// Precision is the minimum number of digits, zero with precision 0 has no digits
+			size_t precision = (f.precision >= 0) ? (size_t) f.precision : 1u;
+			if (f.forceLong && base == 8u && precision <= len) precision = len + 1u;
+			const size_t zeros = (precision > len) ? (precision - len) : 0u;
+
+			/// The 0 flag is ignored when a precision is given
+			_Format field = f;
+			if (f.precision >= 0) field.padZeros = false;
+			_writeField(ret, field, prefix, prefixLen, pos, len, zeros, true);
 		};
-		
-		/// Attempt to capture the current character count printed so far into the referenced int variable
+
+		/// Signed integers are printed as their sign and magnitude for 'd' and 'i', otherwise as their unsigned bit pattern
+		template<typename T, typename U>
+		inline void _formatSigned(_Buffer &ret, const _Format &f, const T val) {
+			if (f.specifier == 'd' || f.specifier == 'i') {
+				const bool negative = (val < 0);
+				_formatInteger(ret, f, negative, negative ? (0ull - (unsigned long long) val) : (unsigned long long) val);
+			}
+			else {
+				_formatInteger(ret, f, false, (unsigned long long) (U) val);
+			}
+		};
+
+		/// Attempt to format an integer
 		template<typename T>
-		inline void _formatCurrentLength(const int _line_, const char *_file_,
-			std::ostringstream &ret,
-			const _Format &f,
-			T &&val) {
-			_printDebug(_line_, _file_);
-			std::cerr << "String Format | _formatCurrentLength called with (" << typeid(val).name() << ")" << std::endl << std::endl;
-			std::exit(EXIT_FAILURE);
+		inline void _formatInt(const int _line_, const char *_file_, _Buffer &ret, const _Format &f, const T &val)
+		{ _formatError(_line_, _file_, "_formatInt", val); };
+		inline void _formatInt(const int _line_, const char *_file_, _Buffer &ret, const _Format &f, const int val)
+		{ _formatSigned<int, unsigned int>(ret, f, val); };
+		inline void _formatInt(const int _line_, const char *_file_, _Buffer &ret, const _Format &f, const short int val)
+		{ _formatSigned<short int, unsigned short int>(ret, f, val); };
+		inline void _formatInt(const int _line_, const char *_file_, _Buffer &ret, const _Format &f, const long int val)
+		{ _formatSigned<long int, unsigned long int>(ret, f, val); };
+		inline void _formatInt(const int _line_, const char *_file_, _Buffer &ret, const _Format &f, const long long int val)
+		{ _formatSigned<long long int, unsigned long long int>(ret, f, val); };
+		inline void _formatInt(const int _line_, const char *_file_, _Buffer &ret, const _Format &f, const unsigned int val)
+		{ _formatInteger(ret, f, false, val); };
+		inline void _formatInt(const int _line_, const char *_file_, _Buffer &ret, const _Format &f, const unsigned short int val)
+		{ _formatInteger(ret, f, false, val); };
+		inline void _formatInt(const int _line_, const char *_file_, _Buffer &ret, const _Format &f, const unsigned long int val)
+		{ _formatInteger(ret, f, false, val); };
+		inline void _formatInt(const int _line_, const char *_file_, _Buffer &ret, const _Format &f, const unsigned long long int val)
+		{ _formatInteger(ret, f, false, val); };
+
+		/// Write an exponent suffix with a sign and at least two digits
+		inline char* _writeExponent(char *pos, const char c, const int exponent) {
+			*(pos++) = c;
+			*(pos++) = (exponent < 0) ? '-' : '+';
+			const unsigned int mag = (unsigned int) ((exponent < 0) ? -exponent : exponent);
+			const unsigned int count = std::max(_countDigits(mag), 2u);
+			pos[0] = pos[1] = '0';
+			_writeDecimal(pos + count, mag);
+			return pos + count;
 		};
-		inline void _formatCurrentLength(const int _line_, const char *_file_, std::ostringstream &ret, const _Format &f, int &val) 
-		{ val = (int) ret.str().size(); };
-		inline void _formatCurrentLength(const int _line_, const char *_file_, std::ostringstream &ret, const _Format &f, short int &val) 
-		{ val = (short int) ret.str().size(); };
-		inline void _formatCurrentLength(const int _line_, const char *_file_, std::ostringstream &ret, const _Format &f, long int &val) 
-		{ val = (long int) ret.str().size(); };
-		inline void _formatCurrentLength(const int _line_, const char *_file_, std::ostringstream &ret, const _Format &f, long long int &val) 
-		{ val = (long long int) ret.str().size(); };
-		inline void _formatCurrentLength(const int _line_, const char *_file_, std::ostringstream &ret, const _Format &f, unsigned int &val) 
-		{ val = (unsigned int) ret.str().size(); };
-		inline void _formatCurrentLength(const int _line_, const char *_file_, std::ostringstream &ret, const _Format &f, unsigned short int &val) 
-		{ val = (unsigned short int) ret.str().size(); };
-		inline void _formatCurrentLength(const int _line_, const char *_file_, std::ostringstream &ret, const _Format &f, unsigned long int &val) 
-		{ val = (unsigned long int) ret.str().size(); };
-		inline void _formatCurrentLength(const int _line_, const char *_file_, std::ostringstream &ret, const _Format &f, unsigned long long int &val) 
-		{ val = (unsigned long long int) ret.str().size(); };
-
-		/**
-		* Handle formatting once possible width/precision arguments have been handled
-		* @param _line_		Pass along the debug macro __LINE__ from the call site
-		* @param _file_		Pass along the debug macro __FILE__ from the call site
-		* @param ret		The ostream to write output to
-		* @param f			The _Format struct representing how to display val
-		* @param val		The value to format
+
+#if defined(__SIZEOF_INT128__)
+		typedef unsigned __int128 _UInt128;
+
+		/// 10^n for n up to 38
+		inline _UInt128 _pow10x128(const unsigned int n) {
+			const unsigned long long *powers = _powersOf10();
+			return (n < 20u) ? (_UInt128) powers[n] : ((_UInt128) powers[19] * powers[n - 19u]);
+		};
+
+		inline unsigned int _bitLength(const _UInt128 val) {
+			const unsigned long long hi = (unsigned long long) (val >> 64), lo = (unsigned long long) val;
+			if (hi != 0)	return 128u - (unsigned int) __builtin_clzll(hi);
+			if (lo != 0)	return 64u - (unsigned int) __builtin_clzll(lo);
+			return 0u;
+		};
+
+		/**
+		* Round m * 2^e * 10^k to the nearest integer with ties to even, exactly
+		* @param m			The significand
+		* @param e			The binary exponent
+		* @param k			The decimal exponent
+		* @param out		The rounded result
+		* @return			False if the result can not be computed exactly within 128 bits
 		*/
-		template<typename T>
-		inline void _formatVal(const int _line_, const char *_file_,
-			std::ostringstream &ret,
-			const _Format &f,
-			T &&val) {
+		inline bool _scaleRound(const unsigned long long m, const int e, const int k, _UInt128 &out) {
+			if (k > 38 || k < -38) return false;
+			_UInt128 num = m, den = 1u;
+			if (k >= 0) {
+				const _UInt128 scale = _pow10x128((unsigned int) k);
+				if (_bitLength(num) + _bitLength(scale) > 128u) return false;
+				num *= scale;
+			}
+			else {
+				den = _pow10x128((unsigned int) -k);
+			}
 
-			/// Provide typechecking on formatting declaration because we know the type of val
-			if (!_checkVal(f.specifier, val)) {
-				_printDebug(_line_, _file_);
-				std::cerr << "String Format | Incorrect format specifier for type (" << typeid(val).name() << "): Saw '" << f.specifier
-						  << "' | Expected '" << _specString(val) << '\'' << std::endl << std::endl;
-				std::exit(EXIT_FAILURE);
+			if (e >= 0) {
+				if (_bitLength(num) + (unsigned int) e > 128u) return false;
+				num <<= e;
+			}
+			else if (k >= 0) {
+				/// Dividing by a power of two, a shift with the remainder bits deciding the rounding
+				const unsigned int shift = (unsigned int) -e;
+				if (shift >= 128u) {
+					out = 0u;
+					return true;
+				}
+				const _UInt128 half = ((_UInt128) 1u) << (shift - 1u), rem = num & ((half << 1) - 1u);
+				out = num >> shift;
+				if (rem > half || (rem == half && (out & 1u))) ++out;
+				return true;
+			}
+			else {
+				if (_bitLength(den) + (unsigned int) -e > 128u) return false;
+				den <<= -e;
 			}
 
-			/// Cache stream state before formatting
-			std::ios state(NULL);
-			state.copyfmt(ret);
+			if (den == 1u) {
+				out = num;
+				return true;
+			}
+			out = num / den;
+			const _UInt128 rem = num - (out * den);
+			if (rem > den - rem || (rem == den - rem && (out & 1u))) ++out;
+			return true;
+		};
 
-			/// Apply flags/width/precision
-			if (f.forceSign)				ret << std::showpos;
-			if (f.forceLong)				ret << std::showpoint << std::showbase;
-			if (f.padZeros)					ret << std::setfill('0');
-			if (f.leftJustify)				ret << std::left;
-			if (f.width >= 0)				ret << std::setw(f.width);
-			if (f.precision >= 0)			ret << std::setprecision(f.precision);
-			if (std::isupper(f.specifier))	ret << std::uppercase;
+		/// Whether m * 2^e < 10^n exactly
+		inline bool _lessThanPow10(const unsigned long long m, const int e, const unsigned int n) {
+			const _UInt128 power = _pow10x128(n);
+			if (e >= 0) return (_bitLength(m) + (unsigned int) e <= 128u) && ((((_UInt128) m) << e) < power);
+			if (_bitLength(power) + (unsigned int) -e > 128u) return true;
+			return m < (power << -e);
+		};
 
-			/// Specifier specific formatting
-			switch (f.specifier) {
-			case 'o':
-				ret << std::oct;
-				break;
-			case 'x':
-			case 'X':
-				ret << std::hex;
-				break;
-			case 'e':
-			case 'E':
-				ret << std::scientific;
-				break;
-			case 'f':
-				ret << std::fixed;
-				break;
-			case 'b':
-			case 'B':
-				{ /// Special case: Need to reinterpret val to apply logic
-					_formatBool(_line_, _file_, ret, f, std::forward<T>(val));
-					ret.copyfmt(state); /// Reset stream state to before _formatVal
-					return;
+		/// Write the decimal digits of val backwards ending at end, returns the first digit
+		inline char* _writeDecimal128(char *end, _UInt128 val) {
+			const unsigned long long chunk = _powersOf10()[19];
+			while ((val >> 64) != 0) {
+				const _UInt128 q = val / chunk;
+				_writeDecimal(end, (unsigned long long) (val - (q * chunk)));
+				std::memset(end - 19, '0', 19u - _countDigits((unsigned long long) (val - (q * chunk))));
+				end -= 19;
+				val = q;
+			}
+			const unsigned int count = _countDigits((unsigned long long) val);
+			_writeDecimal(end, (unsigned long long) val);
+			return end - count;
+		};
+
+		/**
+		* Round to precision + 1 significant digits for scientific notation
+		* @param m			The significand
+		* @param e			The binary exponent
+		* @param precision	Digits after the decimal point
+		* @param digits		Receives exactly precision + 1 digits
+		* @param exponent	Receives the decimal exponent of the first digit
+		* @return			False if the exact path can not handle the value
+		*/
+		inline bool _scientificDigits(const unsigned long long m, const int e, const int precision, char *digits, int &exponent) {
+			if (precision > 37) return false;
+			if (m == 0u) {
+				std::memset(digits, '0', (size_t) precision + 1u);
+				exponent = 0;
+				return true;
+			}
+
+			/// floor(log10(2^x)) for the leading bit, the true exponent is this or one more
+			const int x = (63 - __builtin_clzll(m)) + e;
+			exponent = (x >= 0) ? ((x * 315653) >> 20) : -(((-x * 315653) + ((1 << 20) - 1)) >> 20);
+			_UInt128 val;
+			if (!_scaleRound(m, e, precision - exponent, val)) return false;
+			if (val >= _pow10x128((unsigned int) precision + 1u)) {
+				++exponent;
+				if (!_scaleRound(m, e, precision - exponent, val)) return false;
+			}
+			_writeDecimal128(digits + precision + 1, val);
+			return true;
+		};
+
+		/**
+		* Format the magnitude of a finite double exactly using 128 bit integer arithmetic
+		* @param buf		Output, at least 128 chars
+		* @param f			The _Format struct representing how to display the value
+		* @param mag		The value to format, not negative
+		* @return			Length written, or -1 when the value and precision are outside of the exact range
+		*/
+		inline int _formatDoubleExact(char *buf, const _Format &f, const double mag) {
+			unsigned long long bits;
+			std::memcpy(&bits, &mag, sizeof(bits));
+			const int biased = (int) ((bits >> 52) & 0x7FFu);
+			unsigned long long m = bits & ((1ull << 52) - 1u);
+			int e = -1074;
+			if (biased != 0) {
+				m |= 1ull << 52;
+				e = biased - 1075;
+			}
+
+			char digits[48];
+			char *pos = buf;
+			const char upper = (f.specifier == 'E' || f.specifier == 'G');
+			int precision = (f.precision >= 0) ? f.precision : 6;
+
+			if (f.specifier == 'f') {
+				_UInt128 val = 0u;
+				if (precision > 38 || (m != 0u && !_scaleRound(m, e, precision, val))) return -1;
+				char *end = digits + sizeof(digits);
+				char *start = (val != 0u) ? _writeDecimal128(end, val) : end;
+				const int count = (int) (end - start);
+
+				/// Integer part, then the fraction padded with leading zeros
+				if (count > precision) {
+					std::memcpy(pos, start, (size_t) (count - precision));
+					pos += count - precision;
 				}
-			case 'p':
-				{ /// Special case: Need to reinterpret val to apply logic
-					_formatPtr(_line_, _file_, ret, f, std::forward<T>(val));
-					ret.copyfmt(state); /// Reset stream state to before _formatVal
-					return;
+				else {
+					*(pos++) = '0';
 				}
-			case 's':
-				{ /// Special case: Need to reinterpret val to apply logic
-					_formatString(_line_, _file_, ret, f, std::forward<T>(val));
-					ret.copyfmt(state); /// Reset stream state to before _formatVal
-					return;
+				if (precision > 0 || f.forceLong) *(pos++) = '.';
+				if (count < precision) {
+					std::memset(pos, '0', (size_t) (precision - count));
+					pos += precision - count;
 				}
-			case 'n':
-				{ /// Special case: Need to reinterpret val to apply logic
-					_formatCurrentLength(_line_, _file_, ret, f, std::forward<T>(val));
-					ret.copyfmt(state); /// Reset stream state to before _formatVal
-					return;
+				const int fracCount = std::min(count, precision);
+				std::memcpy(pos, end - fracCount, (size_t) fracCount);
+				pos += fracCount;
+				return (int) (pos - buf);
+			}
+
+			if (f.specifier == 'e' || f.specifier == 'E') {
+				int exponent;
+				if (!_scientificDigits(m, e, precision, digits, exponent)) return -1;
+				*(pos++) = digits[0];
+				if (precision > 0 || f.forceLong) *(pos++) = '.';
+				std::memcpy(pos, digits + 1, (size_t) precision);
+				pos += precision;
+				pos = _writeExponent(pos, upper ? 'E' : 'e', exponent);
+				return (int) (pos - buf);
+			}
+
+			/// 'g' picks fixed or scientific from the exponent after rounding to precision significant digits
+			if (precision == 0) precision = 1;
+			int exponent;
+			if (!_scientificDigits(m, e, precision - 1, digits, exponent)) return -1;
+			int count = precision;
+			if (!f.forceLong) {
+				while (count > 1 && digits[count - 1] == '0') --count;
+			}
+
+			if (precision > exponent && exponent >= -4) {
+				if (exponent >= 0) {
+					const int intCount = exponent + 1;
+					std::memcpy(pos, digits, (size_t) std::min(intCount, count));
+					pos += std::min(intCount, count);
+					if (count < intCount) {
+						std::memset(pos, '0', (size_t) (intCount - count));
+						pos += intCount - count;
+					}
+					if (count > intCount || f.forceLong) *(pos++) = '.';
+					if (count > intCount) {
+						std::memcpy(pos, digits + intCount, (size_t) (count - intCount));
+						pos += count - intCount;
+					}
 				}
+				else {
+					*(pos++) = '0';
+					*(pos++) = '.';
+					std::memset(pos, '0', (size_t) (-exponent - 1));
+					pos += -exponent - 1;
+					std::memcpy(pos, digits, (size_t) count);
+					pos += count;
+				}
+				return (int) (pos - buf);
 			}
 
-			ret << val;
-			ret.copyfmt(state); /// Reset stream state to before _formatVal
+			/// glibc keeps the fraction length picked for fixed notation when rounding carries into scientific
+			if (f.forceLong && exponent == precision && _lessThanPow10(m, e, (unsigned int) precision)) count = 1;
+
+			*(pos++) = digits[0];
+			if (count > 1 || f.forceLong) *(pos++) = '.';
+			std::memcpy(pos, digits + 1, (size_t) (count - 1));
+			pos += count - 1;
+			pos = _writeExponent(pos, upper ? 'E' : 'e', exponent);
+			return (int) (pos - buf);
 		};
+#endif
 
-		/**
-		* Handle formatting when one argument is present
-		* @param _line_		Pass along the debug macro __LINE__ from the call site
-		* @param _file_		Pass along the debug macro __FILE__ from the call site
-		* @param ret		The ostream to write output to
-		* @param pos		Iterator to the current pos in the format string
-		* @param fmtE		Iterator to the end of the format string
-		* @param arg0		The next argument
-		*/
-		template<typename T0>
-		inline void _formatVal(const int _line_, const char *_file_,
-			std::ostringstream &ret,
-			char *pos,
-			char *fmtE,
-			T0 &&arg0) {
+#ifdef STR_EXT_C_LOCALE
+		/// Vector of a trivially copyable type with inline storage for N elements, only allocating once it grows past that
+		template<typename T, size_t N>
+		class _SmallVector {
+		public:
+			_SmallVector() : _ptr(_store), _size(0u), _capacity(N) {};
 
-			/// Modifies pos as it munches the formatting declaration!
-			_Format f = _parseFormat(_line_, _file_, pos, fmtE);
+			inline T* data() { return _ptr; };
+			inline const T* data() const { return _ptr; };
+			inline size_t size() const { return _size; };
+			inline bool empty() const { return _size == 0u; };
+			inline T& operator[](const size_t i) { return _ptr[i]; };
+			inline const T& operator[](const size_t i) const { return _ptr[i]; };
+			inline T& back() { return _ptr[_size - 1u]; };
 
-			if (f.width == -1 && f.precision == -1) {
-				_printDebug(_line_, _file_);
-				std::cerr << "String Format | Not enough arguments: Variable width & precision needs '3' arguments. Have '1'" << std::endl << std::endl;
-				std::exit(EXIT_FAILURE);
+			inline void clear() { _size = 0u; };
+			inline void pop_back() { --_size; };
+			inline void push_back(const T val) {
+				if (_size == _capacity) _reserve(_size + 1u);
+				_ptr[_size++] = val;
+			};
+
+			/// Shrink, or grow filling with val
+			inline void resize(const size_t n, const T val = T()) {
+				if (n > _capacity) _reserve(n);
+				for (size_t i = _size; i < n; ++i) _ptr[i] = val;
+				_size = n;
+			};
+
+			inline void append(const T *vals, const size_t n) {
+				if (_size + n > _capacity) _reserve(_size + n);
+				std::memcpy(_ptr + _size, vals, n * sizeof(T));
+				_size += n;
+			};
+
+			inline void append(const size_t n, const T val) { resize(_size + n, val); };
+
+			/// Insert n copies of val before the first element
+			inline void insertFront(const size_t n, const T val) {
+				if (_size + n > _capacity) _reserve(_size + n);
+				std::memmove(_ptr + n, _ptr, _size * sizeof(T));
+				for (size_t i = 0; i < n; ++i) _ptr[i] = val;
+				_size += n;
+			};
+
+			/// Remove the first n elements
+			inline void eraseFront(const size_t n) {
+				std::memmove(_ptr, _ptr + n, (_size - n) * sizeof(T));
+				_size -= n;
+			};
+
+		private:
+			_SmallVector(const _SmallVector&);
+			_SmallVector& operator=(const _SmallVector&);
+
+			inline void _reserve(const size_t n) {
+				const size_t capacity = std::max(n, _capacity * 2u);
+				const bool wasInline = (_ptr == _store);
+				_heap.resize(capacity);
+				if (wasInline) std::memcpy(_heap.data(), _store, _size * sizeof(T));
+				_ptr = _heap.data();
+				_capacity = capacity;
+			};
+
+			T _store[N];
+			std::vector<T> _heap;
+			T *_ptr;
+			size_t _size, _capacity;
+		};
+
+		/// Arbitrary precision unsigned integer, 32 bit limbs least significant first. 3072 bits are held inline,
+		/// enough for any double and for long doubles within about 10^900 at everyday precisions
+		typedef _SmallVector<unsigned int, 96> _BigInt;
+
+		/// Decimal digits and formatted text of the exact conversion, held inline up to 512 chars
+		typedef _SmallVector<char, 512> _Digits;
+
+		inline void _bigTrim(_BigInt &n) {
+			while (!n.empty() && n.back() == 0u) n.pop_back();
+		};
+
+		/// n = n * mul, mul below 2^32
+		inline void _bigMul(_BigInt &n, const unsigned long long mul) {
+			unsigned long long carry = 0u;
+			for (size_t i = 0; i < n.size(); ++i) {
+				carry += (unsigned long long) n[i] * mul;
+				n[i] = (unsigned int) (carry & 0xFFFFFFFFu);
+				carry >>= 32;
 			}
-			else if (f.width == -1) {
-				_printDebug(_line_, _file_);
-				std::cerr << "String Format | Not enough arguments: Variable width needs '2' arguments. Have '1'" << std::endl << std::endl;
-				std::exit(EXIT_FAILURE);
+			if (carry != 0u) n.push_back((unsigned int) carry);
+		};
+
+		/// n = n / div, div below 2^32, returns the remainder. Kept inline so constant divisors become multiplications
+		inline unsigned int _bigDiv(_BigInt &n, const unsigned long long div) {
+			unsigned long long rem = 0u;
+			for (size_t i = n.size(); i-- > 0;) {
+				rem = (rem << 32) | n[i];
+				n[i] = (unsigned int) (rem / div);
+				rem %= div;
 			}
-			else if (f.precision == -1) {
-				_printDebug(_line_, _file_);
-				std::cerr << "String Format | Not enough arguments: Variable precision needs '2' arguments. Have '1'" << std::endl << std::endl;
-				std::exit(EXIT_FAILURE);
+			_bigTrim(n);
+			return (unsigned int) rem;
+		};
+
+		/// n = n * 2^shift
+		inline void _bigShiftLeft(_BigInt &n, const unsigned int shift) {
+			n.insertFront(shift / 32u, 0u);
+			if ((shift % 32u) != 0u) _bigMul(n, 1ull << (shift % 32u));
+		};
+
+		/// n = n / 2^shift, returns true if any of the bits shifted out were set
+		inline bool _bigShiftRight(_BigInt &n, const unsigned int shift) {
+			const size_t limbs = std::min((size_t) (shift / 32u), n.size());
+			bool inexact = false;
+			for (size_t i = 0; i < limbs; ++i) inexact = inexact || (n[i] != 0u);
+			n.eraseFront(limbs);
+
+			const unsigned int bits = shift % 32u;
+			if (bits != 0u && !n.empty()) {
+				inexact = inexact || ((n[0] & ((1u << bits) - 1u)) != 0u);
+				for (size_t i = 0; i < n.size(); ++i)
+					n[i] = (n[i] >> bits) | ((i + 1u < n.size()) ? (n[i + 1u] << (32u - bits)) : 0u);
 			}
-			else {
-				/// std::forward<T0>(arg0) is the variable to be formatted
-				_formatVal(_line_, _file_, ret, f, std::forward<T0>(std::forward<T0>(arg0)));
-				/// Format the remaining string
-				_format(_line_, _file_, ret, pos, fmtE);
+			_bigTrim(n);
+			return inexact;
+		};
+
+		/// 5^k for k up to 13, the largest power of five below 2^32
+		inline unsigned long long _pow5(const int k) { return _powersOf10()[k] >> k; };
+
+		/// Append the decimal digits of n, n is consumed
+		inline void _bigDecimal(_BigInt &n, _Digits &digits) {
+			/// Nine digits at a time from the least significant end, then written out from the most significant
+			_BigInt chunks;
+			while (!n.empty()) chunks.push_back(_bigDiv(n, 1000000000u));
+			for (size_t i = chunks.size(); i-- > 0;) {
+				char buf[9];
+				const unsigned int count = (i + 1u == chunks.size()) ? _countDigits(chunks[i]) : 9u;
+				std::memset(buf, '0', sizeof(buf));
+				_writeDecimal(buf + sizeof(buf), chunks[i]);
+				digits.append(buf + sizeof(buf) - count, count);
 			}
 		};
 
+		/// floor(log10(2^x))
+		inline int _floorLog10Pow2(const int x) {
+			const long long y = x;
+			return (int) ((y >= 0) ? ((y * 315653) >> 20) : -(((-y * 315653) + ((1 << 20) - 1)) >> 20));
+		};
+
 		/**
-		* Handle formatting when two arguments are present
-		* @param _line_		Pass along the debug macro __LINE__ from the call site
-		* @param _file_		Pass along the debug macro __FILE__ from the call site
-		* @param ret		The ostream to write output to
-		* @param pos		Iterator to the current pos in the format string
-		* @param fmtE		Iterator to the end of the format string
-		* @param arg0		The two next arguments
-		* @param arg1
+		* Decimal digits of a finite value down to 10^low. Only the digits asked for are generated, a final '1'
+		* is appended when anything below 10^low was dropped so rounding above that position still sees it.
+		* @param mag		The value to convert, greater than zero
+		* @param low		Position of the last digit wanted
+		* @param digits		Receives the digits without leading zeros
+		* @return			The decimal exponent of the first digit
 		*/
-		template<typename T0, typename T1>
-		inline void _formatVal(const int _line_, const char *_file_,
-			std::ostringstream &ret,
-			char *pos,
-			char *fmtE,
-			T0 &&arg0, T1 &&arg1) {
+		template<typename T>
+		inline int _decimalDigits(const T mag, const int low, _Digits &digits) {
+			/// Peel the significand off 32 bits at a time so mag == n * 2^e with n an integer
+			int e;
+			T frac = std::frexp(mag, &e);
+			_BigInt n;
+			while (frac != 0) {
+				frac = std::ldexp(frac, 32);
+				const unsigned int limb = (unsigned int) frac;
+				frac -= (T) limb;
+				n.insertFront(1u, limb);
+				e -= 32;
+			}
 
-			/// Modifies pos as it munches the formatting declaration!
-			_Format f = _parseFormat(_line_, _file_, pos, fmtE);
+			/// floor(n * 2^e / 10^low), as n * 5^-low * 2^(e - low)
+			bool inexact = false;
+			for (int k = -low; k > 0; k -= 13) _bigMul(n, _pow5(std::min(k, 13)));
+			if (e - low >= 0)	_bigShiftLeft(n, (unsigned int) (e - low));
+			else				inexact = _bigShiftRight(n, (unsigned int) (low - e));
+			for (int k = low; k > 0; k -= 13) {
+				const unsigned int rem = (k >= 13) ? _bigDiv(n, 1220703125u) : _bigDiv(n, _pow5(k));
+				inexact = inexact || (rem != 0u);
+			}
 
-			if (f.width == -1 && f.precision == -1) {
-				_printDebug(_line_, _file_);
-				std::cerr << "String Format | Not enough arguments: Variable width & precision needs '3' arguments. Have '2'" << std::endl << std::endl;
-				std::exit(EXIT_FAILURE);
+			digits.clear();
+			_bigDecimal(n, digits);
+			const int exponent = low + (int) digits.size() - 1;
+			if (inexact) digits.push_back('1');
+			return exponent;
+		};
+
+		/**
+		* Round a digit string to its first keep digits, ties to even as printf does
+		* @param digits		The digits, shortened to keep or emptied when keep is negative
+		* @param keep		The number of leading digits to keep
+		* @return			True if rounding carried into a new leading digit, digits is then a 1 followed by zeros
+		*/
+		inline bool _roundDigits(_Digits &digits, const long keep) {
+			if (keep >= (long) digits.size()) return false;
+			if (keep < 0) {
+				digits.clear();
+				return false;
 			}
-			else if (f.width == -1) {
-				/// std::forward<T0>(arg0) is the width
-				f.width = _widthArg(_line_, _file_, arg0);
-				/// std::forward<T1>(arg1) is the variable to be formatted
-				_formatVal(_line_, _file_, ret, f, std::forward<T1>(arg1));
-				/// Format the remaining string
-				_format(_line_, _file_, ret, pos, fmtE);
-			}
-			else if (f.precision == -1) {
-				/// std::forward<T0>(arg0) is the precision
-				f.precision = _precisionArg(_line_, _file_, arg0);
-				/// std::forward<T1>(arg1) is the variable to be formatted
-				_formatVal(_line_, _file_, ret, f, std::forward<T1>(arg1));
-				/// Format the remaining string
-				_format(_line_, _file_, ret, pos, fmtE);
+
+			const char next = digits[(size_t) keep];
+			bool up = (next > '5');
+			if (next == '5') {
+				up = (keep > 0 && ((digits[(size_t) keep - 1u] - '0') & 1));
+				for (size_t i = (size_t) keep + 1u; i < digits.size() && !up; ++i) up = (digits[i] != '0');
 			}
-			else {
-				/// std::forward<T0>(arg0) is the variable to be formatted
-				_formatVal(_line_, _file_, ret, f, std::forward<T0>(arg0));
-				/// Format the remaining string, std::forward<T1>(arg1) forwarded
-				_format(_line_, _file_, ret, pos, fmtE, std::forward<T1>(arg1));
+			digits.resize((size_t) keep);
+			if (!up) return false;
+
+			for (size_t i = digits.size(); i-- > 0;) {
+				if (digits[i] != '9') {
+					++digits[i];
+					return false;
+				}
+				digits[i] = '0';
 			}
+			/// All nines, the trailing zero this adds is implied by the writers padding with zeros
+			if (digits.empty())	digits.push_back('1');
+			else				digits[0] = '1';
+			return true;
 		};
 
-		/**
-		* Handle formatting when at least three arguments are present
-		* @param _line_		Pass along the debug macro __LINE__ from the call site
-		* @param _file_		Pass along the debug macro __FILE__ from the call site
-		* @param ret		The ostream to write output to
-		* @param pos		Iterator to the current pos in the format string
-		* @param fmtE		Iterator to the end of the format string
-		* @param arg0		The three next arguments		
-		* @param arg1
-		* @param arg2
-		* @param ...args	The set of remaining arguments to insert into fmt
-		*/
-		template<typename T0, typename T1, typename T2, typename ...Args>
-		inline void _formatVal(const int _line_, const char *_file_,
-			std::ostringstream &ret,
-			char *pos,
-			char *fmtE,
-			T0 &&arg0, T1 &&arg1, T2 &&arg2, Args &&...args) {
-
-			/// Modifies pos as it munches the formatting declaration!
-			_Format f = _parseFormat(_line_, _file_, pos, fmtE);
-
-			if (f.width == -1 && f.precision == -1) {
-				/// std::forward<T0>(arg0) is the width
-				f.width = _widthArg(_line_, _file_, arg0);
-				/// std::forward<T1>(arg1) is the precision
-				f.precision = _precisionArg(_line_, _file_, arg1);
-				/// std::forward<T2>(arg2) is the variable to be formatted
-				_formatVal(_line_, _file_, ret, f, std::forward<T2>(arg2));
-				/// Format the remaining string, std::forward<Args>(args)... forwarded
-				_format(_line_, _file_, ret, pos, fmtE, std::forward<Args>(args)...);
-			}
-			else if (f.width == -1) {
-				/// std::forward<T0>(arg0) is the width
-				f.width = _widthArg(_line_, _file_, arg0);
-				/// std::forward<T1>(arg1) is the variable to be formatted
-				_formatVal(_line_, _file_, ret, f, std::forward<T1>(arg1));
-				/// Format the remaining string, std::forward<T2>(arg2),std::forward<Args>(args)... forwarded
-				_format(_line_, _file_, ret, pos, fmtE, std::forward<T2>(arg2), std::forward<Args>(args)...);
-			}
-			else if (f.precision == -1) {
-				/// std::forward<T0>(arg0) is the precision
-				f.precision = _precisionArg(_line_, _file_, arg0);
-				/// std::forward<T1>(arg1) is the variable to be formatted
-				_formatVal(_line_, _file_, ret, f, std::forward<T1>(arg1));
-				/// Format the remaining string, std::forward<T2>(arg2),std::forward<Args>(args)... forwarded
-				_format(_line_, _file_, ret, pos, fmtE, std::forward<T2>(arg2), std::forward<Args>(args)...);
+		/// Write digits whose first digit is at 10^exponent in fixed notation, digits past the end are zeros
+		inline void _writeFixedDigits(_Digits &out, const _Digits &digits, const int exponent, const int precision, const bool point) {
+			const long size = (long) digits.size();
+			if (exponent >= 0) {
+				const long count = std::min(size, (long) exponent + 1);
+				out.append(digits.data(), (size_t) count);
+				out.append((size_t) (exponent + 1 - count), '0');
 			}
 			else {
-				/// std::forward<T0>(arg0) is the variable to be formatted
-				_formatVal(_line_, _file_, ret, f, std::forward<T0>(arg0));
-				/// Format the remaining string, std::forward<T1>(arg1),std::forward<T2>(arg2),std::forward<Args>(args)... forwarded
-				_format(_line_, _file_, ret, pos, fmtE, std::forward<T1>(arg1), std::forward<T2>(arg2), std::forward<Args>(args)...);
+				out.push_back('0');
 			}
+			if (precision > 0 || point) out.push_back('.');
+
+			/// The fraction starts with zeros when the first digit is after the point
+			const long lead = std::min((long) precision, std::max(-(long) exponent - 1, 0l));
+			out.append((size_t) lead, '0');
+			const long first = (long) exponent + 1 + lead;
+			const long count = std::max(std::min(size - first, (long) precision - lead), 0l);
+			if (count > 0) out.append(digits.data() + first, (size_t) count);
+			out.append((size_t) (precision - lead - count), '0');
+		};
+
+		/// Write at least one digit in scientific notation with precision digits after the first, digits past the end are zeros
+		inline void _writeScientificDigits(_Digits &out, const _Digits &digits, const int exponent,
+			const int precision, const bool point, const char c) {
+
+			out.push_back(digits[0]);
+			if (precision > 0 || point) out.push_back('.');
+			const size_t count = std::min(digits.size() - 1u, (size_t) precision);
+			out.append(digits.data() + 1, count);
+			out.append((size_t) precision - count, '0');
+
+			char buf[8];
+			out.append(buf, (size_t) (_writeExponent(buf, c, exponent) - buf));
 		};
 
 		/**
-		* Recursively munches through the format string when no arguments are left/present
-		* @param _line_		Pass along the debug macro __LINE__ from the call site
-		* @param _file_		Pass along the debug macro __FILE__ from the call site
-		* @param ret		The ostream to write output to
-		* @param fmtS		Iterator to the start of the format string
-		* @param fmtE		Iterator to the end of the format string
+		* Format the magnitude of a finite value exactly as printf would in the "C" locale, using only the library's own code
+		* @param out		Receives the formatted magnitude
+		* @param f			The _Format struct representing how to display the value
+		* @param mag		The value to format, not negative
 		*/
-		inline void _format(const int _line_, const char *_file_,
-			std::ostringstream &ret,
-			char *fmtS,
-			char *fmtE) {
+		template<typename T>
+		inline void _formatFloatClassic(_Digits &out, const _Format &f, const T mag) {
+			int precision = (f.precision >= 0) ? f.precision : 6;
+			const char e = (f.specifier == 'E' || f.specifier == 'G') ? 'E' : 'e';
 
-			auto pos = _findChar(fmtS, fmtE, '%');
-			if (pos != fmtE) {
-				/// Grab fmt before delimiter
-				ret << std::string(fmtS, pos);
+			/// One digit past the last one printed decides the rounding, the estimate may be one below the true exponent
+			_Digits digits;
+			digits.push_back('0');
+			int exponent = 0;
+			if (mag != 0) {
+				int binary;
+				std::frexp(mag, &binary);
+				const int estimate = _floorLog10Pow2(binary - 1);
+				int low = -precision;
+				if (f.specifier == 'e' || f.specifier == 'E')	low = estimate - precision;
+				else if (f.specifier != 'f')					low = estimate - std::max(precision, 1) + 1;
+				exponent = _decimalDigits(mag, low - 1, digits);
+			}
 
-				const auto next = pos + 1;
-				if (next == fmtE) {
-					/// If fmt ends then there was an incomplete format declaration
-					_printDebug(_line_, _file_);
-					std::cerr << "String Format | Incomplete format string: Ended in '%'" << std::endl << std::endl;
-					std::exit(EXIT_FAILURE);
-				}
-				else if (*next == '%') {
-					/// Special case for % sign
-					ret << '%';
-					pos += 2;
-					/// Formate the remaining string
-					_format(_line_, _file_, ret, pos, fmtE);
-				}
-				else {
-					/// If this is actually a format declaration then we don't have any args to insert 
-					_printDebug(_line_, _file_);
-					std::cerr << "String Format | Not enough arguments" << std::endl << std::endl;
-					std::exit(EXIT_FAILURE);
-				}
+			if (f.specifier == 'f') {
+				if (_roundDigits(digits, (long) exponent + precision + 1)) ++exponent;
+				_writeFixedDigits(out, digits, exponent, precision, f.forceLong);
+				return;
 			}
-			else {
-				/// No args, print remaining fmt string
-				ret << std::string(fmtS, fmtE);
+			if (f.specifier == 'e' || f.specifier == 'E') {
+				if (_roundDigits(digits, (long) precision + 1)) ++exponent;
+				_writeScientificDigits(out, digits, exponent, precision, f.forceLong, e);
+				return;
+			}
+
+			/// 'g' picks fixed or scientific from the exponent after rounding to precision significant digits
+			if (precision == 0) precision = 1;
+			const bool carry = _roundDigits(digits, precision);
+			if (carry) ++exponent;
+			int count = precision;
+			if (!f.forceLong) {
+				count = std::min((int) digits.size(), precision);
+				while (count > 1 && digits[(size_t) count - 1u] == '0') --count;
 			}
-		};
 
-		/// Count the number of varadic template arguments
-		inline unsigned int _numArgs() { return 0u; };
-		template<typename T, typename ...Args>
-		inline unsigned int _numArgs(T &&val, Args &&...args) { return 1u + _numArgs(std::forward<Args>(args)...); };
+			if (precision > exponent && exponent >= -4) {
+				_writeFixedDigits(out, digits, exponent, std::max(count - 1 - exponent, 0), f.forceLong);
+				return;
+			}
+
+			/// glibc keeps the fraction length picked for fixed notation when rounding carries into scientific
+			if (f.forceLong && carry && exponent == precision) count = 1;
+			_writeScientificDigits(out, digits, exponent, count - 1, f.forceLong, e);
+		};
+#endif
 
 		/**
-		* Recursively munches through the format string inserting the set of arguments
-		* @param _line_		Pass along the debug macro __LINE__ from the call site
-		* @param _file_		Pass along the debug macro __FILE__ from the call site
-		* @param ret		The ostream to write output to
-		* @param fmtS		Iterator to the start of the format string
-		* @param fmtE		Iterator to the end of the format string
-		* @param ...args	The set of remaining arguments to insert into fmt
+		* Format a floating point value, the sign and padding are applied here. Doubles in the common range are 
+		* converted exactly with integer arithmetic, anything else gets its digits from snprintf, or from the
+		* library's own exact conversion when STR_EXT_C_LOCALE is defined
+		* @param ret		The buffer to write output to
+		* @param f			The _Format struct representing how to display the value
+		* @param val		The value to format
 		*/
-		template<typename ...Args>
-		inline void _format(const int _line_, const char *_file_,
-			std::ostringstream &ret,
-			char *fmtS,
-			char *fmtE,
-			Args &&...args) {
-
-			/// Find the next format delimiter
-			auto pos = _findChar(fmtS, fmtE, '%');
-			if (pos == fmtE) {
-				/// If no delimiter is found print the rest of the fmt string blindly
-				//_format(_line_, _file_, ret, fmtS, fmtE); //  remaining std::forward<Args>(args)... are discarded
+		template<typename T>
+		inline void _formatFloating(_Buffer &ret, const _Format &f, const T val) {
+			const bool negative = std::signbit(val);
+			const bool finite = std::isfinite(val);
 
-				_printDebug(_line_, _file_);
-				std::cerr << "String Format | Unused arguments: '"
-						  << (1u + _numArgs(std::forward<Args>(args)...)) << '\'' << std::endl << std::endl;
-				std::exit(EXIT_FAILURE);
+			const T mag = negative ? -val : val;
+			char buf[128];
+			const char *text = buf;
+			int len = -1;
+#if defined(__SIZEOF_INT128__)
+			if (finite && sizeof(T) == sizeof(double)) len = _formatDoubleExact(buf, f, (double) mag);
+#endif
+#ifdef STR_EXT_C_LOCALE
+			_Digits classic;
+			if (len < 0 && !finite) {
+				const bool upper = (f.specifier == 'E' || f.specifier == 'G');
+				std::memcpy(buf, std::isnan(val) ? (upper ? "NAN" : "nan") : (upper ? "INF" : "inf"), 3u);
+				len = 3;
 			}
-			else {
-				/// Grab fmt before delimiter
-				ret << std::string(fmtS, pos);
+			else if (len < 0) {
+				_formatFloatClassic(classic, f, mag);
+				text = classic.data();
+				len = (int) classic.size();
+			}
+#else
+			/// Build the printf conversion for the magnitude
+			char conv[8];
+			size_t convLen = 0;
+			conv[convLen++] = '%';
+			if (f.forceLong) conv[convLen++] = '#';
+			conv[convLen++] = '.';
+			conv[convLen++] = '*';
+			if (sizeof(T) > sizeof(double)) conv[convLen++] = 'L';
+			conv[convLen++] = f.specifier;
+			conv[convLen] = '\0';
 
-				const auto next = pos + 1;
-				if (next == fmtE) {
-					_printDebug(_line_, _file_);
-					std::cerr << "String Format | Incomplete format string: Ended in '%'" << std::endl << std::endl;
-					std::exit(EXIT_FAILURE);
+			const int precision = (f.precision >= 0) ? f.precision : -1;
+			if (len < 0) len = std::snprintf(buf, sizeof(buf), conv, precision, mag);
+			std::string large;
+			if (len >= (int) sizeof(buf)) {
+				large.resize((size_t) len + 1u);
+				std::snprintf(&(large[0]), large.size(), conv, precision, mag);
+				text = large.data();
+			}
+#endif
+
+			char prefix[1];
+			size_t prefixLen = 0;
+			if (negative)			prefix[prefixLen++] = '-';
+			else if (f.forceSign)	prefix[prefixLen++] = '+';
+
+			/// Infinity and NaN are never zero padded
+			_Format field = f;
+			if (!finite) field.padZeros = false;
+			_writeField(ret, field, prefix, prefixLen, text, (size_t) std::max(len, 0), 0u, true);
+		};
+
+		/// Attempt to format a floating point value
+		template<typename T>
+		inline void _formatFloat(const int _line_, const char *_file_, _Buffer &ret, const _Format &f, const T &val)
+		{ _formatError(_line_, _file_, "_formatFloat", val); };
+		inline void _formatFloat(const int _line_, const char *_file_, _Buffer &ret, const _Format &f, const float val)
+		{ _formatFloating<double>(ret, f, val); };
+		inline void _formatFloat(const int _line_, const char *_file_, _Buffer &ret, const _Format &f, const double val)
+		{ _formatFloating<double>(ret, f, val); };
+		inline void _formatFloat(const int _line_, const char *_file_, _Buffer &ret, const _Format &f, const long double val)
+		{ _formatFloating<long double>(ret, f, val); };
+
+		/// Attempt to format a char
+		template<typename T>
+		inline void _formatChar(const int _line_, const char *_file_, _Buffer &ret, const _Format &f, const T &val)
+		{ _formatError(_line_, _file_, "_formatChar", val); };
+		inline void _formatChar(const int _line_, const char *_file_, _Buffer &ret, const _Format &f, const char val)
+		{ _writeField(ret, f, &val, 1u); };
+		inline void _formatChar(const int _line_, const char *_file_, _Buffer &ret, const _Format &f, const unsigned char val)
+		{ _writeField(ret, f, (const char*) &val, 1u); };
+
+		/// Attempt to format a bool
+		template<typename T>
+		inline void _formatBool(const int _line_, const char *_file_, _Buffer &ret, const _Format &f, const T &val)
+		{ _formatError(_line_, _file_, "_formatBool", val); };
+		inline void _formatBool(const int _line_, const char *_file_,
+			_Buffer &ret,
+			const _Format &f,
+			const bool val) {
+
+			switch (f.specifier) {
+			case 'b':
+				if (f.forceLong) {
+					if (val)	_writeField(ret, f, "true", 4u);
+					else		_writeField(ret, f, "false", 5u);
 				}
-				else if (*next == '%') {
-					/// Special case for % sign
-					ret << '%';
-					pos += 2;
-					/// Formate the remaining string
-					_format(_line_, _file_, ret, pos, fmtE, std::forward<Args>(args)...);
+				else {
+					_writeField(ret, f, (val ? "1" : "0"), 1u);
+				}
+				break;
+			case 'B':
+				if (f.forceLong) {
+					if (val)	_writeField(ret, f, "TRUE", 4u);
+					else		_writeField(ret, f, "FALSE", 5u);
 				}
 				else {
-					/// Format current argument
-					_formatVal(_line_, _file_, ret, pos, fmtE, std::forward<Args>(args)...);
+					_writeField(ret, f, (val ? "T" : "F"), 1u);
 				}
+				break;
 			}
 		};
 
-	}; /// imp namespace
+		/// Attempt to print any pointer type as a hexidecimal size_t
+		template<typename T>
+		inline void _formatPtr(const int _line_, const char *_file_, _Buffer &ret, const _Format &f, const T &val)
+		{ _formatError(_line_, _file_, "_formatPtr", val); };
+		template<typename T>
+		inline void _formatPtr(const int _line_, const char *_file_,
+			_Buffer &ret,
+			const _Format &f,
+			T *val) {
 
-	/// Public interface
-	#define format_str(...) str::format(__LINE__, __FILE__, __VA_ARGS__)
+			_Format field = f;
+			field.specifier = 'x';
+			field.forceLong = true;
+			field.forceSign = false;
+			_formatInteger(ret, field, false, (unsigned long long) (size_t) val);
+		};
 
-	/**
-	 * Formats a string using the set of provided varadic template arguments
-	 * @param _line_	Pass along the debug macro __LINE__ from the call site
-	 * @param _file_	Pass along the debug macro __FILE__ from the call site
-	 * @param fmt		The format string to use
+		/// Write val with its str::formatter, writing no more than precision chars when one is given
+		template<typename T>
+		inline void _formatWith(_Buffer &ret, const int precision, const T &val) {
+			if (precision > 0) {
+				_LimitBuffer limited(ret, (size_t) precision);
+				_Writer out(limited);
+				str::formatter<T>().format(out, val);
+				limited.flush();
+			}
+			else {
+				_Writer out(ret);
+				str::formatter<T>().format(out, val);
+			}
+		};
+
+		/// Attempt to format anything through str::formatter<T>, which defaults to the ostream<< operator
+		template<typename T>
+		inline void _formatString(const int _line_, const char *_file_,
+			_Buffer &ret,
+			const _Format &f,
+			const T &val) {
+			
+			if (f.width > 0 && !f.leftJustify) {
+				/// Right justified text has to be measured before the padding is written
+				_MemoryBuffer<> tmp;
+				_formatWith(tmp, f.precision, val);
+				_writeField(ret, f, tmp.data(), tmp.size());
+			}
+			else {
+				/// Otherwise write straight into the output so large values are never copied
+				const size_t start = ret.written();
+				_formatWith(ret, f.precision, val);
+				const size_t length = ret.written() - start;
+				if (f.width > 0 && (size_t) f.width > length) ret.fill(' ', (size_t) f.width - length);
+			}
+		};
+
+		/**
+		* Format text which is already in memory, precision is the maximum length so nothing is copied first
+		* @param ret		The buffer to write output to
+		* @param f			The _Format struct representing how to display the text
+		* @param s			The text
+		* @param len		Length of the text
+		*/
+		inline void _formatText(_Buffer &ret, const _Format &f, const char *s, size_t len) {
+			if (f.precision > 0 && (size_t) f.precision < len) len = (size_t) f.precision;
+			_writeField(ret, f, s, len);
+		};
+
+		/// Format a nul terminated string, never reading past precision chars
+		inline void _formatCString(_Buffer &ret, const _Format &f, const char *s) {
+			if (s == nullptr) {
+				/// Matches glibc, which prints nothing if "(null)" does not fit in the precision
+				if (f.precision <= 0 || f.precision >= 6)	_formatText(ret, f, "(null)", 6u);
+				else										_formatText(ret, f, "", 0u);
+				return;
+			}
+			if (f.precision > 0) {
+				const void *end = std::memchr(s, '\0', (size_t) f.precision);
+				_formatText(ret, f, s, (end != nullptr) ? (size_t) (static_cast<const char*>(end) - s) : (size_t) f.precision);
+			}
+			else {
+				_formatText(ret, f, s, std::strlen(s));
+			}
+		};
+
+		/// Hex digits of n bytes, two chars per byte
+		inline void _encodeHexScalar(char *out, const unsigned char *in, const size_t n, const bool upper) {
+			const char *pairs = _hexPairs(upper);
+			for (size_t i = 0; i < n; ++i) std::memcpy(out + 2u * i, pairs + 2u * in[i], 2u);
+		};
+
+		/// Base64 of n bytes, four chars per three bytes with '=' padding at the end
+		inline size_t _encodeBase64Scalar(char *out, const unsigned char *in, const size_t n) {
+			static const char digits[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+			char *pos = out;
+			size_t i = 0;
+			for (; i + 3u <= n; i += 3u) {
+				const unsigned int v = ((unsigned int) in[i] << 16) | ((unsigned int) in[i + 1u] << 8) | in[i + 2u];
+				pos[0] = digits[v >> 18];
+				pos[1] = digits[(v >> 12) & 0x3fu];
+				pos[2] = digits[(v >> 6) & 0x3fu];
+				pos[3] = digits[v & 0x3fu];
+				pos += 4;
+			}
+			if (i < n) {
+				const unsigned int v = ((unsigned int) in[i] << 16) | ((i + 1u < n) ? ((unsigned int) in[i + 1u] << 8) : 0u);
+				pos[0] = digits[v >> 18];
+				pos[1] = digits[(v >> 12) & 0x3fu];
+				pos[2] = (i + 1u < n) ? digits[(v >> 6) & 0x3fu] : '=';
+				pos[3] = '=';
+				pos += 4;
+			}
+			return (size_t) (pos - out);
+		};
+
+#ifdef STR_EXT_X86
+		/// Instruction sets the SIMD kernels need, checked once
+		struct _CPU {
+			bool sse2, ssse3, avx2;
+		};
+
+		inline _CPU _detectCPU() {
+			_CPU cpu = { false, false, false };
+#if defined(_MSC_VER) && !defined(__clang__)
+			int info[4];
+			__cpuid(info, 0);
+			const int maxLeaf = info[0];
+			__cpuid(info, 1);
+			cpu.sse2 = (info[3] & (1 << 26)) != 0;
+			cpu.ssse3 = (info[2] & (1 << 9)) != 0;
+			/// AVX2 also needs the OS to save the upper halves of the registers
+			const bool osSaves = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 6u) == 6u;
+			if (maxLeaf >= 7 && osSaves) {
+				__cpuidex(info, 7, 0);
+				cpu.avx2 = (info[1] & (1 << 5)) != 0;
+			}
+#else
+			__builtin_cpu_init();
+			cpu.sse2 = __builtin_cpu_supports("sse2") != 0;
+			cpu.ssse3 = __builtin_cpu_supports("ssse3") != 0;
+			cpu.avx2 = __builtin_cpu_supports("avx2") != 0;
+#endif
+			return cpu;
+		};
+
+		inline const _CPU& _cpu() {
+			static const _CPU cpu = _detectCPU();
+			return cpu;
+		};
+
+		/// Hex digits of 16 bytes at a time, nibbles above 9 are moved up to the letters by a compare rather than a table
+		STR_EXT_TARGET("sse2")
+		inline size_t _encodeHexSSE2(char *out, const unsigned char *in, const size_t n, const bool upper) {
+			const __m128i mask = _mm_set1_epi8(0x0f);
+			const __m128i nine = _mm_set1_epi8(9);
+			const __m128i zero = _mm_set1_epi8('0');
+			const __m128i letters = _mm_set1_epi8((char) ((upper ? 'A' : 'a') - '0' - 10));
+			size_t i = 0;
+			for (; i + 16u <= n; i += 16u) {
+				const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+				const __m128i hi = _mm_and_si128(_mm_srli_epi16(v, 4), mask);
+				const __m128i lo = _mm_and_si128(v, mask);
+				const __m128i hiChars = _mm_add_epi8(_mm_add_epi8(hi, zero), _mm_and_si128(_mm_cmpgt_epi8(hi, nine), letters));
+				const __m128i loChars = _mm_add_epi8(_mm_add_epi8(lo, zero), _mm_and_si128(_mm_cmpgt_epi8(lo, nine), letters));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2u * i), _mm_unpacklo_epi8(hiChars, loChars));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2u * i + 16u), _mm_unpackhi_epi8(hiChars, loChars));
+			}
+			return i;
+		};
+
+		/// Hex digits of 32 bytes at a time, the unpacks work within 128 bit lanes so the halves are put back in order when stored
+		STR_EXT_TARGET("avx2")
+		inline size_t _encodeHexAVX2(char *out, const unsigned char *in, const size_t n, const bool upper) {
+			const __m256i mask = _mm256_set1_epi8(0x0f);
+			const __m256i nine = _mm256_set1_epi8(9);
+			const __m256i zero = _mm256_set1_epi8('0');
+			const __m256i letters = _mm256_set1_epi8((char) ((upper ? 'A' : 'a') - '0' - 10));
+			size_t i = 0;
+			for (; i + 32u <= n; i += 32u) {
+				const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+				const __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), mask);
+				const __m256i lo = _mm256_and_si256(v, mask);
+				const __m256i hiChars = _mm256_add_epi8(_mm256_add_epi8(hi, zero), _mm256_and_si256(_mm256_cmpgt_epi8(hi, nine), letters));
+				const __m256i loChars = _mm256_add_epi8(_mm256_add_epi8(lo, zero), _mm256_and_si256(_mm256_cmpgt_epi8(lo, nine), letters));
+				const __m256i first = _mm256_unpacklo_epi8(hiChars, loChars);
+				const __m256i second = _mm256_unpackhi_epi8(hiChars, loChars);
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 2u * i), _mm256_permute2x128_si256(first, second, 0x20));
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 2u * i + 32u), _mm256_permute2x128_si256(first, second, 0x31));
+			}
+			return i + _encodeHexSSE2(out + 2u * i, in + i, n - i, upper);
+		};
+
+		/// Map 6 bit values to base64 digits, pshufb picks the offset to add for each range of values
+		STR_EXT_TARGET("ssse3")
+		inline __m128i _base64Digits(const __m128i indices) {
+			const __m128i offsets = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+				'0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+			__m128i range = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+			range = _mm_or_si128(range, _mm_and_si128(_mm_cmpgt_epi8(_mm_set1_epi8(26), indices), _mm_set1_epi8(13)));
+			return _mm_add_epi8(_mm_shuffle_epi8(offsets, range), indices);
+		};
+
+		/// Base64 of 12 bytes at a time, reads 16 so stops 4 bytes early
+		STR_EXT_TARGET("ssse3")
+		inline size_t _encodeBase64SSSE3(char *out, const unsigned char *in, const size_t n) {
+			const __m128i spread = _mm_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+			size_t i = 0;
+			for (; i + 16u <= n; i += 12u, out += 16) {
+				const __m128i v = _mm_shuffle_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i)), spread);
+				/// Shift each of the four 6 bit fields of every 32 bit lane into its own byte
+				const __m128i high = _mm_mulhi_epu16(_mm_and_si128(v, _mm_set1_epi32(0x0fc0fc00)), _mm_set1_epi32(0x04000040));
+				const __m128i low = _mm_mullo_epi16(_mm_and_si128(v, _mm_set1_epi32(0x003f03f0)), _mm_set1_epi32(0x01000010));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(out), _base64Digits(_mm_or_si128(high, low)));
+			}
+			return i;
+		};
+
+		STR_EXT_TARGET("avx2")
+		inline __m256i _base64Digits(const __m256i indices) {
+			const __m256i offsets = _mm256_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+				'0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0,
+				'a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+				'0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+			__m256i range = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+			range = _mm256_or_si256(range, _mm256_and_si256(_mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices), _mm256_set1_epi8(13)));
+			return _mm256_add_epi8(_mm256_shuffle_epi8(offsets, range), indices);
+		};
+
+		/// Base64 of 24 bytes at a time, 12 into each 128 bit lane
+		STR_EXT_TARGET("avx2")
+		inline size_t _encodeBase64AVX2(char *out, const unsigned char *in, const size_t n) {
+			const __m256i spread = _mm256_set_epi8(10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1,
+				10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1);
+			size_t i = 0;
+			for (; i + 28u <= n; i += 24u, out += 32) {
+				const __m128i first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+				const __m128i second = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i + 12u));
+				const __m256i v = _mm256_shuffle_epi8(_mm256_inserti128_si256(_mm256_castsi128_si256(first), second, 1), spread);
+				const __m256i high = _mm256_mulhi_epu16(_mm256_and_si256(v, _mm256_set1_epi32(0x0fc0fc00)), _mm256_set1_epi32(0x04000040));
+				const __m256i low = _mm256_mullo_epi16(_mm256_and_si256(v, _mm256_set1_epi32(0x003f03f0)), _mm256_set1_epi32(0x01000010));
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(out), _base64Digits(_mm256_or_si256(high, low)));
+			}
+			return i + _encodeBase64SSSE3(out, in + i, n - i);
+		};
+#endif
+
+		/// Hex digits of n bytes using the widest kernel the CPU supports
+		inline void _encodeHex(char *out, const unsigned char *in, const size_t n, const bool upper) {
+			size_t done = 0;
+#ifdef STR_EXT_X86
+			if (_cpu().avx2)		done = _encodeHexAVX2(out, in, n, upper);
+			else if (_cpu().sse2)	done = _encodeHexSSE2(out, in, n, upper);
+#endif
+			_encodeHexScalar(out + 2u * done, in + done, n - done, upper);
+		};
+
+		/// Base64 of n bytes using the widest kernel the CPU supports, returns the number of chars written
+		inline size_t _encodeBase64(char *out, const unsigned char *in, const size_t n) {
+			size_t done = 0;
+#ifdef STR_EXT_X86
+			if (_cpu().avx2)		done = _encodeBase64AVX2(out, in, n);
+			else if (_cpu().ssse3)	done = _encodeBase64SSSE3(out, in, n);
+#endif
+			return (done / 3u) * 4u + _encodeBase64Scalar(out + (done / 3u) * 4u, in + done, n - done);
+		};
+
+		/**
+		* Write bytes as hex ('h', 'H') or base64 ('m'), precision is the maximum number of bytes and '#' adds a 0x prefix to hex
+		* @param ret		The buffer to write output to
+		* @param f			The _Format struct representing how to display the bytes
+		* @param data		The bytes
+		* @param n			The number of bytes
+		*/
+		inline void _formatBinary(_Buffer &ret, const _Format &f, const unsigned char *data, size_t n) {
+			if (f.precision >= 0 && (size_t) f.precision < n) n = (size_t) f.precision;
+			const bool hex = (f.specifier != 'm');
+			const bool upper = (f.specifier == 'H');
+			const size_t prefix = (hex && f.forceLong) ? 2u : 0u;
+			const size_t length = hex ? prefix + 2u * n : 4u * ((n + 2u) / 3u);
+			const size_t pad = (f.width > 0 && (size_t) f.width > length) ? (size_t) f.width - length : 0u;
+
+			if (!f.leftJustify) ret.fill(' ', pad);
+			if (prefix != 0u) ret.append(upper ? "0X" : "0x", 2u);
+
+			/// Encoded in chunks on the stack, base64 chunks are a whole number of groups so padding only comes at the end
+			char chunk[1024];
+			if (hex) {
+				for (size_t i = 0; i < n; i += sizeof(chunk) / 2u) {
+					const size_t count = std::min(n - i, sizeof(chunk) / 2u);
+					_encodeHex(chunk, data + i, count, upper);
+					ret.append(chunk, 2u * count);
+				}
+			}
+			else {
+				for (size_t i = 0; i < n; i += (sizeof(chunk) / 4u) * 3u) {
+					const size_t count = std::min(n - i, (sizeof(chunk) / 4u) * 3u);
+					ret.append(chunk, _encodeBase64(chunk, data + i, count));
+				}
+			}
+
+			if (f.leftJustify) ret.fill(' ', pad);
+		};
+		
+		/// Attempt to capture the character count printed so far by the current call into the referenced int variable
+		template<typename T>
+		inline void _formatCurrentLength(const int _line_, const char *_file_,
+			const size_t length,
+			const _Format &f,
+			T &&val) {
+			_formatError(_line_, _file_, "_formatCurrentLength", val);
+		};
+		inline void _formatCurrentLength(const int _line_, const char *_file_, const size_t length, const _Format &f, int &val) 
+		{ val = (int) length; };
+		inline void _formatCurrentLength(const int _line_, const char *_file_, const size_t length, const _Format &f, short int &val) 
+		{ val = (short int) length; };
+		inline void _formatCurrentLength(const int _line_, const char *_file_, const size_t length, const _Format &f, long int &val) 
+		{ val = (long int) length; };
+		inline void _formatCurrentLength(const int _line_, const char *_file_, const size_t length, const _Format &f, long long int &val) 
+		{ val = (long long int) length; };
+		inline void _formatCurrentLength(const int _line_, const char *_file_, const size_t length, const _Format &f, unsigned int &val) 
+		{ val = (unsigned int) length; };
+		inline void _formatCurrentLength(const int _line_, const char *_file_, const size_t length, const _Format &f, unsigned short int &val) 
+		{ val = (unsigned short int) length; };
+		inline void _formatCurrentLength(const int _line_, const char *_file_, const size_t length, const _Format &f, unsigned long int &val) 
+		{ val = (unsigned long int) length; };
+		inline void _formatCurrentLength(const int _line_, const char *_file_, const size_t length, const _Format &f, unsigned long long int &val) 
+		{ val = (unsigned long long int) length; };
+
+		/// Kinds of argument the formatting loop handles directly, everything else is formatted through a function pointer
+		enum _ArgType {
+			_argInt, _argShort, _argLong, _argLongLong,
+			_argUInt, _argUShort, _argULong, _argULongLong,
+			_argFloat, _argDouble, _argLongDouble,
+			_argChar, _argUChar, _argBool, _argPointer,
+			_argString, _argCString, _argCharArray, _argStringView, _argCustom,
+			_argText,	/// Text owned elsewhere, ptr and size, used for arguments captured by value
+			_argBinary	/// Byte container or str::bytes, ptr and size
+		};
+
+		template<typename T> struct _ArgKind						{ static const _ArgType value = _IsBytes<T>::value ? _argBinary : _argCustom; };
+		template<typename T> struct _ArgKind<T*>					{ static const _ArgType value = _argPointer; };
+		template<> struct _ArgKind<int>								{ static const _ArgType value = _argInt; };
+		template<> struct _ArgKind<short int>						{ static const _ArgType value = _argShort; };
+		template<> struct _ArgKind<long int>						{ static const _ArgType value = _argLong; };
+		template<> struct _ArgKind<long long int>					{ static const _ArgType value = _argLongLong; };
+		template<> struct _ArgKind<unsigned int>					{ static const _ArgType value = _argUInt; };
+		template<> struct _ArgKind<unsigned short int>				{ static const _ArgType value = _argUShort; };
+		template<> struct _ArgKind<unsigned long int>				{ static const _ArgType value = _argULong; };
+		template<> struct _ArgKind<unsigned long long int>			{ static const _ArgType value = _argULongLong; };
+		template<> struct _ArgKind<float>							{ static const _ArgType value = _argFloat; };
+		template<> struct _ArgKind<double>							{ static const _ArgType value = _argDouble; };
+		template<> struct _ArgKind<long double>						{ static const _ArgType value = _argLongDouble; };
+		template<> struct _ArgKind<char>							{ static const _ArgType value = _argChar; };
+		template<> struct _ArgKind<unsigned char>					{ static const _ArgType value = _argUChar; };
+		template<> struct _ArgKind<bool>							{ static const _ArgType value = _argBool; };
+		template<> struct _ArgKind<std::string>						{ static const _ArgType value = _argString; };
+		template<> struct _ArgKind<char*>							{ static const _ArgType value = _argCString; };
+		template<> struct _ArgKind<const char*>						{ static const _ArgType value = _argCString; };
+		template<size_t N> struct _ArgKind<char[N]>					{ static const _ArgType value = _argCharArray; };
+#ifdef STR_EXT_CPP17
+		template<> struct _ArgKind<std::string_view>				{ static const _ArgType value = _argStringView; };
+#endif
+
+		typedef void (*_CustomFormat)(const int, const char*, _Buffer&, const _Format&, const void*);
+
+		/// Type erased reference to one format argument
+		struct _Arg {
+			_ArgType type;
+			const char *specs;				/// Valid specifiers, _Spec<T>::chars()
+			const void *ptr;				/// Address of the argument, or the pointer itself for _argPointer and _argCString
+			size_t size;					/// Length of _argCharArray, _argText and _argBinary arguments
+			_CustomFormat custom;			/// Formats _argCustom arguments
+			const std::type_info *info;		/// For error messages
+		};
+
+		/// Format a type the formatting loop does not know about
+		template<typename T>
+		inline void _formatCustom(const int _line_, const char *_file_, _Buffer &ret, const _Format &f, const void *ptr) {
+			_formatString(_line_, _file_, ret, f, *static_cast<const T*>(ptr));
+		};
+
+		template<typename T, bool Custom = (_ArgKind<T>::value == _argCustom)>
+		struct _CustomFn											{ static constexpr _CustomFormat get() { return &_formatCustom<T>; }; };
+		template<typename T>
+		struct _CustomFn<T, false>									{ static constexpr _CustomFormat get() { return nullptr; }; };
+
+		template<typename T>
+		inline const void* _argPtr(const T &val) { return &val; };
+		template<typename T>
+		inline const void* _argPtr(T *const &val) { return (const void*) val; };
+		inline const void* _argPtr(const bytes &val) { return val.data; };
+		template<typename B, typename A>
+		inline typename std::enable_if<_IsByte<B>::value, const void*>::type _argPtr(const std::vector<B, A> &val) { return val.data(); };
+		template<typename B, size_t N>
+		inline typename std::enable_if<_IsByte<B>::value, const void*>::type _argPtr(const std::array<B, N> &val) { return val.data(); };
+
+		/// Length of arrays and byte containers
+		template<typename T>
+		inline size_t _argSize(const T &val) { return std::extent<T>::value; };
+		inline size_t _argSize(const bytes &val) { return val.size; };
+		template<typename B, typename A>
+		inline size_t _argSize(const std::vector<B, A> &val) { return val.size(); };
+		template<typename B, size_t N>
+		inline size_t _argSize(const std::array<B, N> &val) { return N; };
+
+		/**
+		* Erase the type of a format argument
+		* @param val		The argument, temporaries are typechecked as const as they cannot be written to by %n
+		* @return			Returns a reference to val tagged with how to check and format it
+		*/
+		template<typename T>
+		inline _Arg _makeArg(T &&val) {
+			typedef typename std::remove_reference<T>::type Val;
+			typedef typename std::conditional<std::is_lvalue_reference<T>::value, Val, const Val>::type Checked;
+			typedef typename std::remove_cv<Val>::type Kind;
+			const _Arg arg = { _ArgKind<Kind>::value, _Spec<Checked>::chars(), _argPtr(val), _argSize(val), 
+				_CustomFn<Kind>::get(), &typeid(Val) };
+			return arg;
+		};
+
+		/// Read a '*' width or precision argument, only integer types are accepted
+		inline int _sizeArg(const int _line_, const char *_file_, const _Arg &arg, const char *name) {
+			switch (arg.type) {
+			case _argInt:			return (int) *static_cast<const int*>(arg.ptr);
+			case _argShort:			return (int) *static_cast<const short int*>(arg.ptr);
+			case _argLong:			return (int) *static_cast<const long int*>(arg.ptr);
+			case _argLongLong:		return (int) *static_cast<const long long int*>(arg.ptr);
+			case _argUInt:			return (int) *static_cast<const unsigned int*>(arg.ptr);
+			case _argUShort:		return (int) *static_cast<const unsigned short int*>(arg.ptr);
+			case _argULong:			return (int) *static_cast<const unsigned long int*>(arg.ptr);
+			case _argULongLong:		return (int) *static_cast<const unsigned long long int*>(arg.ptr);
+			default:
+				_printDebug(_line_, _file_);
+				std::cerr << "String Format | Invalid " << name << " argument: (" << arg.info->name() << ")" << std::endl << std::endl;
+				std::exit(EXIT_FAILURE);
+				return 0;
+			}
+		};
+
+		/// Provide typechecking on formatting declaration because we know the type of the argument
+		inline void _checkArg(const int _line_, const char *_file_, const _Format &f, const _Arg &arg) {
+			if (!_containsChar(f.specifier, arg.specs)) {
+				_printDebug(_line_, _file_);
+				std::cerr << "String Format | Incorrect format specifier for type (" << arg.info->name() << "): Saw '" << f.specifier
+						  << "' | Expected '" << _specString(arg.specs) << '\'' << std::endl << std::endl;
+				std::exit(EXIT_FAILURE);
+			}
+		};
+
+		/**
+		* Consume the '*' width and precision arguments of a declaration and typecheck the value argument
+		* @param _line_		Pass along the debug macro __LINE__ from the call site
+		* @param _file_		Pass along the debug macro __FILE__ from the call site
+		* @param f			The declaration, '*' width and precision are filled in
+		* @param args		The arguments
+		* @param numArgs	The number of arguments
+		* @param index		Index of the first argument consumed by the declaration
+		* @return			Returns the index of the value argument
+		*/
+		inline size_t _bindArgs(const int _line_, const char *_file_, _Format &f, const _Arg *args, const size_t numArgs, size_t index) {
+			const size_t needed = 1u + (f.width == -1 ? 1u : 0u) + (f.precision == -1 ? 1u : 0u);
+			const size_t have = numArgs - index;
+			if (have < needed) {
+				_printDebug(_line_, _file_);
+				std::cerr << "String Format | Not enough arguments";
+				if (have > 0) {
+					std::cerr << ": Variable " << ((needed == 3u) ? "width & precision" : ((f.width == -1) ? "width" : "precision"))
+							  << " needs '" << needed << "' arguments. Have '" << have << '\'';
+				}
+				std::cerr << std::endl << std::endl;
+				std::exit(EXIT_FAILURE);
+			}
+
+			if (f.width == -1)		_setWidth(f, _sizeArg(_line_, _file_, args[index++], "width"));
+			if (f.precision == -1)	_setPrecision(f, _sizeArg(_line_, _file_, args[index++], "precision"));
+			_checkArg(_line_, _file_, f, args[index]);
+			return index;
+		};
+
+		/// Write the character count of the current call into a typechecked %n argument
+		inline void _formatCurrentLength(const int _line_, const char *_file_, const size_t length, const _Format &f, const _Arg &arg) {
+			void *ptr = const_cast<void*>(arg.ptr);
+			switch (arg.type) {
+			case _argInt:			_formatCurrentLength(_line_, _file_, length, f, *static_cast<int*>(ptr)); return;
+			case _argShort:			_formatCurrentLength(_line_, _file_, length, f, *static_cast<short int*>(ptr)); return;
+			case _argLong:			_formatCurrentLength(_line_, _file_, length, f, *static_cast<long int*>(ptr)); return;
+			case _argLongLong:		_formatCurrentLength(_line_, _file_, length, f, *static_cast<long long int*>(ptr)); return;
+			case _argUInt:			_formatCurrentLength(_line_, _file_, length, f, *static_cast<unsigned int*>(ptr)); return;
+			case _argUShort:		_formatCurrentLength(_line_, _file_, length, f, *static_cast<unsigned short int*>(ptr)); return;
+			case _argULong:			_formatCurrentLength(_line_, _file_, length, f, *static_cast<unsigned long int*>(ptr)); return;
+			case _argULongLong:		_formatCurrentLength(_line_, _file_, length, f, *static_cast<unsigned long long int*>(ptr)); return;
+			default:
+				_printDebug(_line_, _file_);
+				std::cerr << "String Format | _formatCurrentLength called with (" << arg.info->name() << ")" << std::endl << std::endl;
+				std::exit(EXIT_FAILURE);
+				return;
+			}
+		};
+
+		/// Write the bytes of an argument for '%h', '%H' and '%m'
+		inline void _formatEncoded(const int _line_, const char *_file_, _Buffer &ret, const _Format &f, const _Arg &arg) {
+			const char *s = static_cast<const char*>(arg.ptr);
+			size_t size = arg.size;
+			switch (arg.type) {
+			case _argString:
+				s = static_cast<const std::string*>(arg.ptr)->data();
+				size = static_cast<const std::string*>(arg.ptr)->size();
+				break;
+#ifdef STR_EXT_CPP17
+			case _argStringView:
+				s = static_cast<const std::string_view*>(arg.ptr)->data();
+				size = static_cast<const std::string_view*>(arg.ptr)->size();
+				break;
+#endif
+			case _argCString:
+				if (s == nullptr) break;
+				if (f.precision >= 0) {
+					const void *end = std::memchr(s, '\0', (size_t) f.precision);
+					size = (end != nullptr) ? (size_t) (static_cast<const char*>(end) - s) : (size_t) f.precision;
+				}
+				else {
+					size = std::strlen(s);
+				}
+				break;
+			case _argCharArray: {
+				const void *end = std::memchr(s, '\0', arg.size);
+				if (end != nullptr) size = (size_t) (static_cast<const char*>(end) - s);
+				break;
+			}
+			case _argPointer:
+				/// A bare pointer has no length, the precision gives it
+				if (f.precision < 0) {
+					_printDebug(_line_, _file_);
+					std::cerr << "String Format | Binary format of a pointer needs a precision giving the number of bytes: Saw '%" 
+							  << f.specifier << "' | Expected '%.*" << f.specifier << '\'' << std::endl << std::endl;
+					std::exit(EXIT_FAILURE);
+				}
+				size = (size_t) f.precision;
+				break;
+			default:
+				break;
+			}
+
+			if (s == nullptr && (arg.type == _argCString || arg.type == _argPointer)) {
+				_writeField(ret, f, "(null)", 6u);
+				return;
+			}
+			_formatBinary(ret, f, reinterpret_cast<const unsigned char*>(s), size);
+		};
+
+		/**
+		* Handle formatting of an already typechecked argument
+		* @param _line_		Pass along the debug macro __LINE__ from the call site
+		* @param _file_		Pass along the debug macro __FILE__ from the call site
+		* @param ret		The buffer to write output to
+		* @param f			The _Format struct representing how to display the argument
+		* @param arg		The argument to format
+		* @param start		The number of characters ret held when the current call started, %n counts from there
+		*/
+		inline void _formatArg(const int _line_, const char *_file_, _Buffer &ret, const _Format &f, const _Arg &arg, const size_t start) {
+			if (f.specifier == 'n') {
+				_formatCurrentLength(_line_, _file_, ret.written() - start, f, arg);
+				return;
+			}
+			if (f.specifier == 'h' || f.specifier == 'H' || f.specifier == 'm') {
+				_formatEncoded(_line_, _file_, ret, f, arg);
+				return;
+			}
+
+			/// Type specific formatting, flags/width/precision are applied by each _formatXXX directly
+			switch (arg.type) {
+			case _argInt:			_formatInt(_line_, _file_, ret, f, *static_cast<const int*>(arg.ptr)); return;
+			case _argShort:			_formatInt(_line_, _file_, ret, f, *static_cast<const short int*>(arg.ptr)); return;
+			case _argLong:			_formatInt(_line_, _file_, ret, f, *static_cast<const long int*>(arg.ptr)); return;
+			case _argLongLong:		_formatInt(_line_, _file_, ret, f, *static_cast<const long long int*>(arg.ptr)); return;
+			case _argUInt:			_formatInt(_line_, _file_, ret, f, *static_cast<const unsigned int*>(arg.ptr)); return;
+			case _argUShort:		_formatInt(_line_, _file_, ret, f, *static_cast<const unsigned short int*>(arg.ptr)); return;
+			case _argULong:			_formatInt(_line_, _file_, ret, f, *static_cast<const unsigned long int*>(arg.ptr)); return;
+			case _argULongLong:		_formatInt(_line_, _file_, ret, f, *static_cast<const unsigned long long int*>(arg.ptr)); return;
+			case _argFloat:			_formatFloat(_line_, _file_, ret, f, *static_cast<const float*>(arg.ptr)); return;
+			case _argDouble:		_formatFloat(_line_, _file_, ret, f, *static_cast<const double*>(arg.ptr)); return;
+			case _argLongDouble:	_formatFloat(_line_, _file_, ret, f, *static_cast<const long double*>(arg.ptr)); return;
+			case _argChar:			_formatChar(_line_, _file_, ret, f, *static_cast<const char*>(arg.ptr)); return;
+			case _argUChar:			_formatChar(_line_, _file_, ret, f, *static_cast<const unsigned char*>(arg.ptr)); return;
+			case _argBool:			_formatBool(_line_, _file_, ret, f, *static_cast<const bool*>(arg.ptr)); return;
+			case _argPointer:		_formatPtr(_line_, _file_, ret, f, arg.ptr); return;
+			case _argString: {
+				const std::string &s = *static_cast<const std::string*>(arg.ptr);
+				_formatText(ret, f, s.data(), s.size());
+				return;
+			}
+			case _argCString:
+				if (f.specifier == 'p')	_formatPtr(_line_, _file_, ret, f, arg.ptr);
+				else					_formatCString(ret, f, static_cast<const char*>(arg.ptr));
+				return;
+			case _argCharArray: {
+				/// Up to the first nul, never past the end of the array
+				const char *s = static_cast<const char*>(arg.ptr);
+				const void *end = std::memchr(s, '\0', arg.size);
+				_formatText(ret, f, s, (end != nullptr) ? (size_t) (static_cast<const char*>(end) - s) : arg.size);
+				return;
+			}
+#ifdef STR_EXT_CPP17
+			case _argStringView: {
+				const std::string_view &s = *static_cast<const std::string_view*>(arg.ptr);
+				_formatText(ret, f, s.data(), s.size());
+				return;
+			}
+#endif
+			case _argCustom:		arg.custom(_line_, _file_, ret, f, arg.ptr); return;
+			case _argText:			_formatText(ret, f, static_cast<const char*>(arg.ptr), arg.size); return;
+			default:				return;
+			}
+		};
+
+		/// Literal text of the format string, copied into most buffers
+		inline void _appendLiteral(_Buffer &ret, const char *s, const size_t n) {
+			ret.append(s, n);
+		};
+#ifdef STR_EXT_POSIX
+		inline void _appendLiteral(_IovecBuffer &ret, const char *s, const size_t n) {
+			ret.literal(s, n);
+		};
+#endif
+
+		/**
+		* Munches through the format string inserting the type erased arguments
+		* @param _line_		Pass along the debug macro __LINE__ from the call site
+		* @param _file_		Pass along the debug macro __FILE__ from the call site
+		* @param ret		The buffer to write output to, a _Buffer or one which handles literals itself
+		* @param pos		Iterator to the start of the format string
+		* @param fmtE		Iterator to the end of the format string
+		* @param args		The arguments to insert into the format string
+		* @param numArgs	The number of arguments
+		*/
+		template<typename Buffer>
+		inline void _vformatWith(const int _line_, const char *_file_,
+			Buffer &ret,
+			const char *pos,
+			const char *fmtE,
+			const _Arg *args,
+			const size_t numArgs) {
+
+			const size_t start = ret.written();
+			size_t index = 0;
+			while (true) {
+				/// Grab fmt before delimiter
+				const char *next = _findChar(pos, fmtE, '%');
+				if (next == fmtE && index < numArgs) {
+					_printDebug(_line_, _file_);
+					std::cerr << "String Format | Unused arguments: '" << (numArgs - index) << '\'' << std::endl << std::endl;
+					std::exit(EXIT_FAILURE);
+				}
+				_appendLiteral(ret, pos, (size_t) (next - pos));
+				if (next == fmtE) return;
+
+				if (next + 1 == fmtE) {
+					/// If fmt ends then there was an incomplete format declaration
+					_printDebug(_line_, _file_);
+					std::cerr << "String Format | Incomplete format string: Ended in '%'" << std::endl << std::endl;
+					std::exit(EXIT_FAILURE);
+				}
+				else if (*(next + 1) == '%') {
+					/// Special case for % sign
+					ret.push_back('%');
+					pos = next + 2;
+				}
+				else {
+					/// Modifies pos as it munches the formatting declaration!
+					pos = next;
+					_Format f = _parseFormat(_line_, _file_, pos, fmtE);
+					index = _bindArgs(_line_, _file_, f, args, numArgs, index);
+					_formatArg(_line_, _file_, ret, f, args[index++], start);
+				}
+			}
+		};
+
+		/// The one non-template formatting loop shared by every buffer
+		inline void _vformat(const int _line_, const char *_file_,
+			_Buffer &ret,
+			const char *pos,
+			const char *fmtE,
+			const _Arg *args,
+			const size_t numArgs) {
+			_vformatWith(_line_, _file_, ret, pos, fmtE, args, numArgs);
+		};
+
+		/// Whitespace as matched by scan, the C locale set
+		inline bool _isSpace(const char c) {
+			return c == ' ' || (c >= '\t' && c <= '\r');
+		};
+
+		inline const char* _skipSpace(const char *pos, const char *end) {
+			while (pos != end && _isSpace(*pos)) ++pos;
+			return pos;
+		};
+
+		/// Value of a digit in base 8, 10 or 16, or base when it is not one
+		inline unsigned int _digitValue(const char c, const unsigned int base) {
+			const unsigned int d = (c >= '0' && c <= '9') ? (unsigned int) (c - '0')
+								 : (c >= 'a' && c <= 'f') ? (unsigned int) (c - 'a' + 10)
+								 : (c >= 'A' && c <= 'F') ? (unsigned int) (c - 'A' + 10) : 16u;
+			return (d < base) ? d : base;
+		};
+
+		/**
+		* Read an unsigned number, hex may have a 0x prefix as written by '%#x'
+		* @param pos		Iterator to the input, moved past the number
+		* @param end		End of the field
+		* @param base		8, 10 or 16
+		* @param max		Largest value allowed
+		* @param out		The value read
+		* @return			Returns the error, if any
+		*/
+		inline scan_result::error_type _scanUnsigned(const char *&pos, const char *end, const unsigned int base,
+			const unsigned long long max, unsigned long long &out) {
+
+			if (base == 16u && end - pos > 2 && pos[0] == '0' && (pos[1] == 'x' || pos[1] == 'X') && _digitValue(pos[2], 16u) < 16u) pos += 2;
+			if (pos == end) return scan_result::end_of_input;
+			if (_digitValue(*pos, base) == base) return scan_result::invalid;
+
+			bool overflow = false;
+			unsigned long long val = 0u;
+			for (unsigned int d; pos != end && (d = _digitValue(*pos, base)) != base; ++pos) {
+				if (val > (max - d) / base) overflow = true;
+				else val = val * base + d;
+			}
+			out = val;
+			return overflow ? scan_result::out_of_range : scan_result::ok;
+		};
+
+		/// Read a signed decimal number with an optional sign
+		inline scan_result::error_type _scanSigned(const char *&pos, const char *end, const long long min, const long long max, long long &out) {
+			const bool negative = (pos != end && *pos == '-');
+			if (pos != end && (*pos == '-' || *pos == '+')) ++pos;
+			unsigned long long mag = 0u;
+			const unsigned long long limit = negative ? (0ull - (unsigned long long) min) : (unsigned long long) max;
+			const scan_result::error_type error = _scanUnsigned(pos, end, 10u, limit, mag);
+			out = negative ? (long long) (0ull - mag) : (long long) mag;
+			return error;
+		};
+
+		/// Read an integer argument, 'd' and 'i' read a sign and magnitude, other specifiers the unsigned bit pattern as written by format
+		template<typename T>
+		inline scan_result::error_type _scanInt(const char *&pos, const char *end, const _Format &f, void *ptr) {
+			typedef typename std::make_unsigned<T>::type U;
+			if (std::is_signed<T>::value && (f.specifier == 'd' || f.specifier == 'i')) {
+				long long val = 0;
+				const scan_result::error_type error = _scanSigned(pos, end, (long long) std::numeric_limits<T>::min(), (long long) std::numeric_limits<T>::max(), val);
+				if (error == scan_result::ok) *static_cast<T*>(ptr) = (T) val;
+				return error;
+			}
+			const unsigned int base = (f.specifier == 'o') ? 8u : ((f.specifier == 'x' || f.specifier == 'X') ? 16u : 10u);
+			unsigned long long val = 0u;
+			const scan_result::error_type error = _scanUnsigned(pos, end, base, (unsigned long long) std::numeric_limits<U>::max(), val);
+			if (error == scan_result::ok) *static_cast<T*>(ptr) = (T) (U) val;
+			return error;
+		};
+
+		/// Largest significand and power of ten which are both exact in T, so one multiply or divide rounds correctly
+		template<typename T> struct _FastFloat				{ static const unsigned long long maxSignificand = 0u; static const int maxPow10 = -1; };
+		template<> struct _FastFloat<float>					{ static const unsigned long long maxSignificand = 1ull << 24; static const int maxPow10 = 10; };
+		template<> struct _FastFloat<double>				{ static const unsigned long long maxSignificand = 1ull << 53; static const int maxPow10 = 22; };
+
+		/// Powers of ten which are exact as a double
+		inline const double* _exactPowersOf10() {
+			static const double powers[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+				1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+			return powers;
+		};
+
+		inline void _strtoFloat(const char *text, float &out)			{ out = std::strtof(text, nullptr); };
+		inline void _strtoFloat(const char *text, double &out)			{ out = std::strtod(text, nullptr); };
+		inline void _strtoFloat(const char *text, long double &out)		{ out = std::strtold(text, nullptr); };
+
+		/**
+		* Read a float the fast path could not, correctly rounded
+		* @param start		Start of the number, already checked to be well formed
+		* @param end		End of the number
+		* @param large		The number is at least 1, so being out of range is an overflow rather than an underflow to 0
+		* @param out		The value read
+		* @return			Returns out_of_range if the number is too large for T
+		*/
+		template<typename T>
+		inline scan_result::error_type _scanFloatSlow(const char *start, const char *end, const bool large, T &out) {
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+			/// from_chars reads the range as it is, but does not take a '+'
+			const bool negative = (*start == '-');
+			if (*start == '+') ++start;
+			if (std::from_chars(start, end, out).ec != std::errc::result_out_of_range) return scan_result::ok;
+			if (large) return scan_result::out_of_range;
+			out = negative ? -(T) 0 : (T) 0;
+			return scan_result::ok;
+#else
+			/// strto* need the number nul terminated, and return infinity on overflow
+			(void) large;
+			const size_t len = (size_t) (end - start);
+			char buf[128];
+			std::string copy;
+			char *text = buf;
+			if (len >= sizeof(buf)) {
+				copy.assign(start, len);
+				text = &(copy[0]);
+			}
+			else {
+				std::memcpy(buf, start, len);
+				buf[len] = '\0';
+			}
+			_strtoFloat(text, out);
+			return (out == std::numeric_limits<T>::infinity() || out == -std::numeric_limits<T>::infinity()) ? scan_result::out_of_range : scan_result::ok;
+#endif
+		};
+
+		/**
+		* Read a floating point number as written by '%f', '%e' and '%g', including inf and nan
+		* @param pos		Iterator to the input, moved past the number
+		* @param end		End of the field
+		* @param ptr		The argument to assign
+		* @return			Returns the error, if any
+		*/
+		template<typename T>
+		inline scan_result::error_type _scanFloat(const char *&pos, const char *end, void *ptr) {
+			const char *const start = pos;
+			const char *cur = pos;
+			const bool negative = (cur != end && *cur == '-');
+			if (cur != end && (*cur == '-' || *cur == '+')) ++cur;
+
+			/// inf, infinity and nan in any case
+			const auto matchWord = [&cur, end](const char *word) {
+				size_t n = 0;
+				while (word[n] != '\0' && cur + n != end && (cur[n] | 0x20) == word[n]) ++n;
+				if (word[n] != '\0') return false;
+				cur += n;
+				return true;
+			};
+			if (matchWord("infinity") || matchWord("inf")) {
+				*static_cast<T*>(ptr) = negative ? -std::numeric_limits<T>::infinity() : std::numeric_limits<T>::infinity();
+				pos = cur;
+				return scan_result::ok;
+			}
+			if (matchWord("nan")) {
+				*static_cast<T*>(ptr) = negative ? -std::numeric_limits<T>::quiet_NaN() : std::numeric_limits<T>::quiet_NaN();
+				pos = cur;
+				return scan_result::ok;
+			}
+
+			/// Up to 19 significant digits are gathered for the fast path
+			unsigned long long significand = 0u;
+			int digits = 0, exponent = 0;
+			bool any = false, exact = true;
+			for (; cur != end && *cur >= '0' && *cur <= '9'; ++cur, any = true) {
+				if (significand == 0u && *cur == '0') continue;
+				if (digits < 19) significand = significand * 10u + (unsigned int) (*cur - '0'), ++digits;
+				else exact = false, ++exponent;
+			}
+			if (cur != end && *cur == '.') {
+				for (++cur; cur != end && *cur >= '0' && *cur <= '9'; ++cur, any = true) {
+					if (significand == 0u && *cur == '0') { --exponent; continue; }
+					if (digits < 19) significand = significand * 10u + (unsigned int) (*cur - '0'), ++digits, --exponent;
+					else exact = false;
+				}
+			}
+			if (!any) return (cur == end) ? scan_result::end_of_input : scan_result::invalid;
+			if (cur != end && (*cur == 'e' || *cur == 'E')) {
+				const char *exp = cur + 1;
+				const bool expNegative = (exp != end && *exp == '-');
+				if (exp != end && (*exp == '-' || *exp == '+')) ++exp;
+				if (exp != end && *exp >= '0' && *exp <= '9') {
+					int val = 0;
+					for (; exp != end && *exp >= '0' && *exp <= '9'; ++exp) if (val < 100000) val = val * 10 + (*exp - '0');
+					exponent += expNegative ? -val : val;
+					cur = exp;
+				}
+			}
+
+			if (exact && significand <= _FastFloat<T>::maxSignificand && exponent >= -_FastFloat<T>::maxPow10 && exponent <= _FastFloat<T>::maxPow10) {
+				const double *powers = _exactPowersOf10();
+				T val = (T) significand;
+				if (exponent < 0)	val /= (T) powers[-exponent];
+				else				val *= (T) powers[exponent];
+				*static_cast<T*>(ptr) = negative ? -val : val;
+				pos = cur;
+				return scan_result::ok;
+			}
+
+			/// Too many digits or too large an exponent for one exact multiply or divide
+			T val = 0;
+			const scan_result::error_type error = _scanFloatSlow(start, cur, digits + exponent > 0, val);
+			if (error != scan_result::ok) return error;
+			*static_cast<T*>(ptr) = val;
+			pos = cur;
+			return scan_result::ok;
+		};
+
+		/// Read a bool as written by '%b', '%#b', '%B' or '%#B'
+		inline scan_result::error_type _scanBool(const char *&pos, const char *end, void *ptr) {
+			static const char *words[] = { "true", "TRUE", "false", "FALSE", "1", "T", "0", "F" };
+			for (size_t i = 0; i < 8u; ++i) {
+				const size_t n = std::strlen(words[i]);
+				if ((size_t) (end - pos) >= n && std::memcmp(pos, words[i], n) == 0) {
+					*static_cast<bool*>(ptr) = (i < 2u || i == 4u || i == 5u);
+					pos += n;
+					return scan_result::ok;
+				}
+			}
+			return (pos == end) ? scan_result::end_of_input : scan_result::invalid;
+		};
+
+		/// Read text up to whitespace or the stop char, the first char of the literal after the declaration
+		inline scan_result::error_type _scanText(const char *&pos, const char *end, const char *stop, const _Arg &arg) {
+			const char *start = pos;
+			while (pos != end && !_isSpace(*pos) && (stop == nullptr || *pos != *stop)) ++pos;
+			const size_t len = (size_t) (pos - start);
+			switch (arg.type) {
+			case _argString:
+				static_cast<std::string*>(const_cast<void*>(arg.ptr))->assign(start, len);
+				return scan_result::ok;
+			case _argCharArray:
+				if (len >= arg.size) {
+					pos = start;
+					return scan_result::out_of_range;
+				}
+				std::memcpy(const_cast<void*>(arg.ptr), start, len);
+				static_cast<char*>(const_cast<void*>(arg.ptr))[len] = '\0';
+				return scan_result::ok;
+#ifdef STR_EXT_CPP17
+			case _argStringView:
+				*static_cast<std::string_view*>(const_cast<void*>(arg.ptr)) = std::string_view(start, len);
+				return scan_result::ok;
+#endif
+			default:
+				return scan_result::invalid;
+			}
+		};
+
+		/**
+		* Read one typechecked argument from the input
+		* @param pos		Iterator to the input, moved past the value
+		* @param end		End of the input
+		* @param f			The declaration, a width limits the chars read after any leading whitespace
+		* @param stop		The literal char which ends '%s', nullptr if there is none
+		* @param arg		The argument to assign
+		* @return			Returns the error, if any
+		*/
+		inline scan_result::error_type _scanArg(const char *&pos, const char *end, const _Format &f, const char *stop, const _Arg &arg) {
+			/// Everything but '%c' skips leading whitespace, as field widths pad with spaces
+			if (f.specifier != 'c') pos = _skipSpace(pos, end);
+			if (f.width > 0 && (size_t) f.width < (size_t) (end - pos)) end = pos + f.width;
+			if (pos == end) return scan_result::end_of_input;
+
+			void *ptr = const_cast<void*>(arg.ptr);
+			switch (arg.type) {
+			case _argInt:			return _scanInt<int>(pos, end, f, ptr);
+			case _argShort:			return _scanInt<short int>(pos, end, f, ptr);
+			case _argLong:			return _scanInt<long int>(pos, end, f, ptr);
+			case _argLongLong:		return _scanInt<long long int>(pos, end, f, ptr);
+			case _argUInt:			return _scanInt<unsigned int>(pos, end, f, ptr);
+			case _argUShort:		return _scanInt<unsigned short int>(pos, end, f, ptr);
+			case _argULong:			return _scanInt<unsigned long int>(pos, end, f, ptr);
+			case _argULongLong:		return _scanInt<unsigned long long int>(pos, end, f, ptr);
+			case _argFloat:			return _scanFloat<float>(pos, end, ptr);
+			case _argDouble:		return _scanFloat<double>(pos, end, ptr);
+			case _argLongDouble:	return _scanFloat<long double>(pos, end, ptr);
+			case _argChar:			*static_cast<char*>(ptr) = *(pos++); return scan_result::ok;
+			case _argUChar:			*static_cast<unsigned char*>(ptr) = (unsigned char) *(pos++); return scan_result::ok;
+			case _argBool:			return _scanBool(pos, end, ptr);
+			default:				return _scanText(pos, end, stop, arg);
+			}
+		};
+
+		/// Types str::scan can read into, the arguments must also be writable
+		template<typename T> struct _Scannable {
+			static const _ArgType kind = _ArgKind<T>::value;
+			static const bool value = kind <= _argBool || kind == _argString || kind == _argCharArray || kind == _argStringView;
+		};
+		template<typename T> struct _Scannable<const T>				{ static const bool value = false; };
+
+		template<typename ...Args> struct _AllScannable				{ static const bool value = true; };
+		template<typename T, typename ...Args> struct _AllScannable<T, Args...> {
+			static const bool value = _Scannable<T>::value && _AllScannable<Args...>::value;
+		};
+
+		/**
+		* Munches through the format string reading the type erased arguments from the input
+		* @param _line_		Pass along the debug macro __LINE__ from the call site
+		* @param _file_		Pass along the debug macro __FILE__ from the call site
+		* @param in			Start of the input
+		* @param inE		End of the input
+		* @param pos		Iterator to the start of the format string
+		* @param fmtE		Iterator to the end of the format string
+		* @param args		The arguments to assign, must be writable
+		* @param numArgs	The number of arguments
+		* @return			Returns how far scanning got and why it stopped
+		*/
+		inline scan_result _vscan(const int _line_, const char *_file_,
+			const char *in, const char *inE,
+			const char *pos, const char *fmtE,
+			const _Arg *args, const size_t numArgs) {
+
+			scan_result ret;
+			const char *cur = in;
+			size_t index = 0;
+			while (pos != fmtE) {
+				if (*pos != '%' || (pos + 1 != fmtE && pos[1] == '%')) {
+					/// Whitespace matches any amount of whitespace, everything else must match exactly
+					if (ret.error != scan_result::ok)	{}
+					else if (_isSpace(*pos))			cur = _skipSpace(cur, inE);
+					else if (cur == inE)				ret.error = scan_result::end_of_input;
+					else if (*cur != *pos)				ret.error = scan_result::mismatch;
+					else								++cur;
+					pos += (*pos == '%') ? 2 : 1;
+					continue;
+				}
+
+				if (pos + 1 == fmtE) {
+					/// If fmt ends then there was an incomplete format declaration
+					_printDebug(_line_, _file_);
+					std::cerr << "String Format | Incomplete format string: Ended in '%'" << std::endl << std::endl;
+					std::exit(EXIT_FAILURE);
+				}
+
+				/// Modifies pos as it munches the formatting declaration!
+				_Format f = _parseFormat(_line_, _file_, pos, fmtE);
+				if (f.width == -1 || f.precision == -1) {
+					_printDebug(_line_, _file_);
+					std::cerr << "String Format | Scan widths must be given in the format string, not as '*'" << std::endl << std::endl;
+					std::exit(EXIT_FAILURE);
+				}
+				if (_containsChar(f.specifier, "phHm")) {
+					_printDebug(_line_, _file_);
+					std::cerr << "String Format | Specifier can not be scanned: '" << f.specifier << '\'' << std::endl << std::endl;
+					std::exit(EXIT_FAILURE);
+				}
+				index = _bindArgs(_line_, _file_, f, args, numArgs, index);
+
+				/// Once the input has failed the rest of the format string is still checked against the arguments
+				const _Arg &arg = args[index++];
+				if (ret.error != scan_result::ok) continue;
+				if (f.specifier == 'n') {
+					_formatCurrentLength(_line_, _file_, (size_t) (cur - in), f, arg);
+					continue;
+				}
+				const char *stop = (pos != fmtE && *pos != '%' && !_isSpace(*pos)) ? pos : nullptr;
+				ret.error = _scanArg(cur, inE, f, stop, arg);
+				if (ret.error == scan_result::ok) ++ret.count;
+			}
+			ret.pos = (size_t) (cur - in);
+
+			if (index < numArgs) {
+				_printDebug(_line_, _file_);
+				std::cerr << "String Format | Unused arguments: '" << (numArgs - index) << '\'' << std::endl << std::endl;
+				std::exit(EXIT_FAILURE);
+			}
+			return ret;
+		};
+
+		/// Text given as a char*, std::string or std::string_view, referenced without copying
+		struct _TextRef {
+			_TextRef(const char *s) : data(s), size(std::strlen(s)) {};
+			_TextRef(const std::string &s) : data(s.data()), size(s.size()) {};
+#ifdef STR_EXT_CPP17
+			_TextRef(const std::string_view s) : data(s.data()), size(s.size()) {};
+#endif
+			const char *data;
+			size_t size;
+		};
+
+		template<typename ...Args>
+		inline scan_result _scan(const int _line_, const char *_file_, const char *in, const size_t inSize, const char *fmt, const size_t fmtSize, Args &...args) {
+			static_assert(_AllScannable<Args...>::value, "str::scan arguments must be non-const integers, floats, char, bool, std::string, char arrays or std::string_view");
+			const _Arg argArray[] = { _makeArg(args)..., _Arg() };
+			return _vscan(_line_, _file_, in, in + inSize, fmt, fmt + fmtSize, argArray, sizeof...(Args));
+		};
+
+		/// One literal segment of a pre-parsed format string followed by the format declaration after it
+		struct _Segment {
+			size_t litS, litE;	/// Literal segment [litS, litE) preceding the declaration
+			_Format f;			/// Specifier is '%' for an escaped percent sign and 0 for the trailing literal
+		};
+
+		/**
+		* Munches through the whole format string once, splitting it into literal segments and format declarations
+		* @param _line_		Pass along the debug macro __LINE__ from the call site
+		* @param _file_		Pass along the debug macro __FILE__ from the call site
+		* @param fmt		The format string to parse
+		* @return			Returns the segments of fmt, the last segment is always the trailing literal
+		*/
+		inline std::vector<_Segment> _parseSegments(const int _line_, const char *_file_, const std::string &fmt) {
+			std::vector<_Segment> segments;
+			const char *fmtS = fmt.data(), *fmtE = fmt.data() + fmt.size();
+			const char *pos = fmtS;
+			while (true) {
+				_Segment seg;
+				/// Grab fmt before delimiter
+				const char *next = _findChar(pos, fmtE, '%');
+				seg.litS = (size_t) (pos - fmtS);
+				seg.litE = (size_t) (next - fmtS);
+				if (next == fmtE) {
+					segments.push_back(seg);
+					return segments;
+				}
+				else if (next + 1 == fmtE) {
+					/// If fmt ends then there was an incomplete format declaration
+					_printDebug(_line_, _file_);
+					std::cerr << "String Format | Incomplete format string: Ended in '%'" << std::endl << std::endl;
+					std::exit(EXIT_FAILURE);
+				}
+				else if (*(next + 1) == '%') {
+					/// Special case for % sign
+					seg.f.specifier = '%';
+					pos = next + 2;
+				}
+				else {
+					/// Modifies pos as it munches the formatting declaration!
+					pos = next;
+					seg.f = _parseFormat(_line_, _file_, pos, fmtE);
+				}
+				segments.push_back(seg);
+			}
+		};
+
+		/// Skip escaped percent signs until the next declaration which consumes arguments
+		inline const _Segment* _skipSegments(const _Segment *seg) {
+			while (seg->f.specifier == '%') ++seg;
+			return seg;
+		};
+
+		/// Write literal segments and escaped percent signs until the next declaration which consumes arguments
+		inline const _Segment* _writeSegments(const char *fmt, _Buffer &ret, const _Segment *seg) {
+			while (true) {
+				ret.append(fmt + seg->litS, seg->litE - seg->litS);
+				if (seg->f.specifier != '%') return seg;
+				ret.push_back('%');
+				++seg;
+			}
+		};
+
+		/**
+		* Typechecks the arguments against pre-parsed segments without formatting them
+		* @param _line_		Pass along the debug macro __LINE__ from the call site
+		* @param _file_		Pass along the debug macro __FILE__ from the call site
+		* @param seg		The first segment
+		* @param args		The arguments
+		* @param numArgs	The number of arguments
+		*/
+		inline void _checkSegments(const int _line_, const char *_file_, const _Segment *seg, const _Arg *args, const size_t numArgs) {
+			size_t index = 0;
+			for (seg = _skipSegments(seg); seg->f.specifier != 0; seg = _skipSegments(seg + 1)) {
+				_Format f = seg->f;
+				index = _bindArgs(_line_, _file_, f, args, numArgs, index) + 1u;
+			}
+			if (index < numArgs) {
+				_printDebug(_line_, _file_);
+				std::cerr << "String Format | Unused arguments: '" << (numArgs - index) << '\'' << std::endl << std::endl;
+				std::exit(EXIT_FAILURE);
+			}
+		};
+
+		/**
+		* Formats already typechecked arguments into pre-parsed segments
+		* @param _line_		Pass along the debug macro __LINE__ from the call site
+		* @param _file_		Pass along the debug macro __FILE__ from the call site
+		* @param fmt		The format string the segments refer to
+		* @param ret		The buffer to write output to
+		* @param seg		The first segment
+		* @param args		The arguments
+		*/
+		inline void _formatSegments(const int _line_, const char *_file_, const char *fmt, _Buffer &ret, const _Segment *seg, const _Arg *args) {
+			const size_t start = ret.written();
+			size_t index = 0;
+			for (seg = _writeSegments(fmt, ret, seg); seg->f.specifier != 0; seg = _writeSegments(fmt, ret, seg + 1)) {
+				_Format f = seg->f;
+				if (f.width == -1)		_setWidth(f, _sizeArg(_line_, _file_, args[index++], "width"));
+				if (f.precision == -1)	_setPrecision(f, _sizeArg(_line_, _file_, args[index++], "precision"));
+				_formatArg(_line_, _file_, ret, f, args[index++], start);
+			}
+		};
+
+		/// Unique address per argument type list, used to remember which argument types have already been typechecked
+		template<typename ...Args>
+		struct _Signature { static const char id; };
+		template<typename ...Args>
+		const char _Signature<Args...>::id = 0;
+
+		/// Columns are anything with data() and size(), or a plain array
+		template<typename C>
+		inline auto _columnData(const C &col) -> decltype(col.data()) { return col.data(); };
+		template<typename T, size_t N>
+		inline const T* _columnData(const T (&col)[N]) { return col; };
+		template<typename C>
+		inline size_t _columnSize(const C &col) { return (size_t) col.size(); };
+		template<typename T, size_t N>
+		inline size_t _columnSize(const T (&col)[N]) { return N; };
+
+		template<typename C>
+		struct _ColumnType { typedef typename std::remove_cv<typename std::remove_pointer<decltype(_columnData(std::declval<const C&>()))>::type>::type type; };
+
+		/**
+		* Type erased argument for the elements of a column, ptr is set for each row by _setRow
+		* @return			Returns the argument pointing at zeros, enough for typechecking '*' width and precision columns
+		*/
+		template<typename C>
+		inline _Arg _columnArg() {
+			typedef typename _ColumnType<C>::type Kind;
+			static const unsigned long long zeros[2] = { 0u, 0u };
+			const _Arg arg = { _ArgKind<Kind>::value, _Spec<const Kind>::chars(), zeros, std::extent<Kind>::value,
+				_CustomFn<Kind>::get(), &typeid(const Kind) };
+			return arg;
+		};
+
+		/// Number of rows, every column must have the same number
+		inline size_t _columnRows(const int _line_, const char *_file_, const size_t *sizes, const size_t numCols) {
+			for (size_t i = 1; i < numCols; ++i) {
+				if (sizes[i] != sizes[0]) {
+					_printDebug(_line_, _file_);
+					std::cerr << "String Format | Column sizes differ: Column '0' has '" << sizes[0] << "' rows | Column '" 
+							  << i << "' has '" << sizes[i] << "' rows" << std::endl << std::endl;
+					std::exit(EXIT_FAILURE);
+				}
+			}
+			return sizes[0];
+		};
+
+		/// Point each column's argument at its element in row
+		inline void _setRow(_Arg *args, const size_t row) {};
+		template<typename C, typename ...Cols>
+		inline void _setRow(_Arg *args, const size_t row, const C &col, const Cols &...cols) {
+			args->ptr = _argPtr(_columnData(col)[row]);
+			args->size = _argSize(_columnData(col)[row]);
+			_setRow(args + 1, row, cols...);
+		};
+
+		/**
+		* Formats one row for every element of the columns, parsing and typechecking the format only once
+		* @param _line_		Pass along the debug macro __LINE__ from the call site
+		* @param _file_		Pass along the debug macro __FILE__ from the call site
+		* @param ret		The buffer to write output to
+		* @param fmt		The format string for one row
+		* @param ...cols	The columns, one per argument of fmt
+		*/
+		template<typename ...Cols>
+		inline void _formatRows(const int _line_, const char *_file_, _Buffer &ret, const std::string &fmt, const Cols &...cols) {
+			static_assert(sizeof...(Cols) > 0, "String Format | format_rows needs at least one column");
+			const std::vector<_Segment> segments = _parseSegments(_line_, _file_, fmt);
+			_Arg args[] = { _columnArg<Cols>()..., _Arg() };
+			_checkSegments(_line_, _file_, &(segments[0]), args, sizeof...(Cols));
+
+			const size_t sizes[] = { _columnSize(cols)... };
+			const size_t rows = _columnRows(_line_, _file_, sizes, sizeof...(Cols));
+			for (size_t row = 0; row < rows; ++row) {
+				_setRow(args, row, cols...);
+				_formatSegments(_line_, _file_, fmt.data(), ret, &(segments[0]), args);
+			}
+		};
+
+		/// Point the arguments at the fields of a tuple returned by a format_parallel projection
+		template<size_t I, typename Tuple>
+		inline typename std::enable_if<(I == std::tuple_size<Tuple>::value)>::type _setTupleArgs(_Arg *args, const Tuple &fields) {};
+		template<size_t I, typename Tuple>
+		inline typename std::enable_if<(I < std::tuple_size<Tuple>::value)>::type _setTupleArgs(_Arg *args, const Tuple &fields) {
+			args[I] = _makeArg(std::get<I>(fields));
+			_setTupleArgs<I + 1u>(args, fields);
+		};
+
+		/// Chunks of records shared between the threads of one format_parallel call
+		struct _ParallelJob {
+			size_t chunks, window;	/// At most window chunks past the last one consumed are formatted ahead
+			size_t next, consumed;
+			bool stop;				/// Set once the job ends or fails, no more chunks are claimed
+			std::exception_ptr error;	/// The first exception thrown on a worker thread
+			std::vector<std::string> texts;
+			std::vector<char> done;
+			std::mutex mutex;
+			std::condition_variable ready, room;
+
+			_ParallelJob(const size_t chunks, const size_t window) :
+				chunks(chunks), window(window), next(0u), consumed(0u), stop(false), texts(chunks), done(chunks, 0) {};
+
+			/// Claim the next chunk to format, lock must be held, returns chunks when there is none to take yet
+			inline size_t claim() {
+				return (!stop && next < chunks && next < consumed + window) ? next++ : chunks;
+			};
+
+			/// Stop the job and wake every waiting thread, keeping the first exception, lock must be held
+			inline void fail(const std::exception_ptr e) {
+				if (!error) error = e;
+				stop = true;
+				ready.notify_all();
+				room.notify_all();
+			};
+		};
+
+		/// The worker threads of a format_parallel call, stopped and joined when the calling thread returns or unwinds
+		struct _ParallelWorkers {
+			_ParallelJob &job;
+			std::vector<std::thread> threads;
+
+			explicit _ParallelWorkers(_ParallelJob &job) : job(job) {};
+			~_ParallelWorkers() { join(); };
+
+			inline void join() {
+				{
+					std::lock_guard<std::mutex> lock(job.mutex);
+					job.stop = true;
+					job.room.notify_all();
+				}
+				for (std::thread &thread : threads) {
+					if (thread.joinable()) thread.join();
+				}
+			};
+		};
+
+		/**
+		* Formats one record per element of [begin, end) across several threads, the output is handed on in order.
+		* The format is parsed once and typechecked once against the first record. The calling thread formats
+		* chunks too while it waits for the next chunk in order.
+		* @param _line_		Pass along the debug macro __LINE__ from the call site
+		* @param _file_		Pass along the debug macro __FILE__ from the call site
+		* @param fmt		The format string for one record
+		* @param begin		Random access iterator to the first record
+		* @param end		Random access iterator past the last record
+		* @param proj		Returns a std::tuple of the arguments for a record, called concurrently
+		* @param threads		The number of threads to format with, including the calling thread
+		* @param window		The most chunks formatted ahead of the one being consumed, bounds memory use
+		* @param consume	Called on the calling thread with the text of each chunk in order, it may move from the string
+		* An exception from proj or consume stops and joins the workers, then is rethrown on the calling thread.
+		*/
+		template<typename It, typename Proj, typename Consume>
+		inline void _formatParallel(const int _line_, const char *_file_, const std::string &fmt, const It begin, const It end,
+			const Proj &proj, const size_t threads, const size_t window, Consume &&consume) {
+
+			static_assert(std::is_base_of<std::random_access_iterator_tag, typename std::iterator_traits<It>::iterator_category>::value,
+						  "String Format | format_parallel needs random access iterators");
+			typedef typename std::decay<decltype(proj(*begin))>::type Tuple;
+			const std::vector<_Segment> segments = _parseSegments(_line_, _file_, fmt);
+			const size_t rows = (size_t) (end - begin);
+			if (rows == 0u) return;
+			{
+				const Tuple fields = proj(*begin);
+				_Arg args[std::tuple_size<Tuple>::value + 1u];
+				_setTupleArgs<0u>(args, fields);
+				_checkSegments(_line_, _file_, &(segments[0]), args, std::tuple_size<Tuple>::value);
+			}
+
+			/// Enough chunks per thread that threads finishing early can take work from the slower ones
+			const size_t chunkSize = std::min(std::max(rows / (threads * 16u), (size_t) 256u), (size_t) 65536u);
+			const size_t chunks = (rows + chunkSize - 1u) / chunkSize;
+			_ParallelJob job(chunks, std::min(std::max(window, (size_t) 1u), chunks));
+
+			const auto formatChunk = [&](const size_t chunk) {
+				std::string text;
+				_StringBuffer ret(text);
+				_Arg args[std::tuple_size<Tuple>::value + 1u];
+				const size_t last = std::min(rows, (chunk + 1u) * chunkSize);
+				for (size_t row = chunk * chunkSize; row < last; ++row) {
+					const Tuple fields = proj(begin[row]);
+					_setTupleArgs<0u>(args, fields);
+					_formatSegments(_line_, _file_, fmt.data(), ret, &(segments[0]), args);
+				}
+				ret.flush();
+
+				std::lock_guard<std::mutex> lock(job.mutex);
+				job.texts[chunk] = std::move(text);
+				job.done[chunk] = 1;
+				job.ready.notify_one();
+			};
+
+			_ParallelWorkers workers(job);
+			for (size_t i = 1; i < std::min(threads, chunks); ++i) {
+				workers.threads.push_back(std::thread([&]() {
+					try {
+						while (true) {
+							size_t chunk;
+							{
+								std::unique_lock<std::mutex> lock(job.mutex);
+								job.room.wait(lock, [&job]() {
+									return job.stop || job.next >= job.chunks || job.next < job.consumed + job.window;
+								});
+								chunk = job.claim();
+							}
+							if (chunk == chunks) return;
+							formatChunk(chunk);
+						}
+					} catch (...) {
+						std::lock_guard<std::mutex> lock(job.mutex);
+						job.fail(std::current_exception());
+					}
+				}));
+			}
+
+			std::unique_lock<std::mutex> lock(job.mutex);
+			while (job.consumed < chunks && !job.error) {
+				if (job.done[job.consumed]) {
+					std::string text = std::move(job.texts[job.consumed]);
+					++job.consumed;
+					job.room.notify_all();
+					lock.unlock();
+					consume(text);
+					lock.lock();
+					continue;
+				}
+				const size_t chunk = job.claim();
+				if (chunk == chunks) {
+					job.ready.wait(lock);
+					continue;
+				}
+				lock.unlock();
+				formatChunk(chunk);
+				lock.lock();
+			}
+			lock.unlock();
+			workers.join();
+			if (job.error) std::rethrow_exception(job.error);
+		};
+
+#ifdef STR_EXT_CPP14
+		/// Base of the types generated by fmt_lit(...), marks a format string known at compile time
+		struct _Literal {};
+#ifdef STR_EXT_CPP20
+		/// A string literal held by value so it can be a template argument
+		template<size_t N>
+		struct _FixedString {
+			char chars[N];
+
+			constexpr _FixedString(const char (&s)[N]) : chars() {
+				for (size_t i = 0; i < N; ++i) chars[i] = s[i];
+			};
+		};
+
+		/// The _Literal for a format string given as a template argument
+		template<_FixedString F>
+		struct _FixedLiteral : _Literal {
+			static constexpr const char* data() { return F.chars; };
+			static constexpr size_t size() { return sizeof(F.chars) - 1u; };
+		};
+#endif
+
+		/// Compile-time format errors, calling these from a constant expression fails compilation with their name
+		inline void _ctErrorIncompleteFormat() {};
+		inline void _ctErrorFlagAlreadySet() {};
+		inline void _ctErrorUndefinedSpecifier() {};
+		inline void _ctErrorOutOfRange() {};
+
+		/// One literal segment of a compile-time format string followed by the format declaration after it
+		struct _CTItem {
+			size_t litS, litE;	/// Literal segment [litS, litE) preceding the declaration
+			size_t end;			/// Position in the format string after the declaration
+			size_t arg;			/// Index of the first argument consumed by the declaration
+			_Format f;			/// Specifier is '%' for an escaped percent sign and 0 for the trailing literal
+		};
+
+		/// Number of arguments consumed by a declaration, including '*' width and precision
+		constexpr size_t _ctNumArgs(const _Format &f) {
+			return (f.specifier == 0 || f.specifier == '%') ? 0u 
+				 : (1u + (f.width == -1 ? 1u : 0u) + (f.precision == -1 ? 1u : 0u));
+		};
+
+		/// Munch a number from a compile-time format string
+		constexpr int _ctNumber(const char *s, const size_t n, size_t &pos) {
+			int val = 0;
+			while (pos < n && s[pos] >= '0' && s[pos] <= '9') {
+				const int digit = s[pos++] - '0';
+				if (val > (INT_MAX - digit) / 10) _ctErrorOutOfRange();
+				val = (val * 10) + digit;
+			}
+			return val;
+		};
+
+		/**
+		* Compile-time equivalent of _format/_parseFormat, munches the literal and declaration starting at pos
+		* @param s			The format string
+		* @param n			Length of the format string
+		* @param pos		Position to start munching from
+		* @param arg		Index of the next unconsumed argument
+		* @return			Returns a _CTItem describing the literal segment and the declaration which follows it
+		*/
+		constexpr _CTItem _ctParseItem(const char *s, const size_t n, size_t pos, const size_t arg) {
+			_CTItem item { pos, pos, pos, arg, _Format() };
+
+			/// Grab fmt before delimiter
+			while (pos < n && s[pos] != '%') ++pos;
+			item.litE = item.end = pos;
+			if (pos == n) return item;
+
+			if (++pos == n) _ctErrorIncompleteFormat();
+			if (s[pos] == '%') {
+				/// Special case for % sign
+				item.f.specifier = '%';
+				item.end = pos + 1;
+				return item;
+			}
+
+			/// Flags
+			for (bool flags = true; flags && pos < n;) {
+				switch (s[pos]) {
+				case '-':
+					if (item.f.leftJustify) _ctErrorFlagAlreadySet();
+					item.f.leftJustify = true;
+					break;
+				case '+':
+					if (item.f.forceSign) _ctErrorFlagAlreadySet();
+					item.f.forceSign = true;
+					break;
+				case '0':
+					if (item.f.padZeros) _ctErrorFlagAlreadySet();
+					item.f.padZeros = true;
+					break;
+				case '#':
+					if (item.f.forceLong) _ctErrorFlagAlreadySet();
+					item.f.forceLong = true;
+					break;
+				default:
+					flags = false;
+					continue;
+				}
+				++pos;
+			}
+
+			/// Width
+			if (pos < n && s[pos] == '*') {
+				item.f.width = -1;
+				++pos;
+			}
+			else if (pos < n && s[pos] >= '0' && s[pos] <= '9') {
+				item.f.width = _ctNumber(s, n, pos);
+			}
+
+			/// Precision
+			if (pos < n && s[pos] == '.') {
+				if (++pos < n && s[pos] == '*') {
+					item.f.precision = -1;
+					++pos;
+				}
+				else if (pos < n && s[pos] >= '0' && s[pos] <= '9') {
+					item.f.precision = _ctNumber(s, n, pos);
+				}
+			}
+
+			/// Specifier
+			if (pos == n || !_containsChar(s[pos], "diuoxXnfeEgGaAscpbBhHm")) _ctErrorUndefinedSpecifier();
+			item.f.specifier = s[pos];
+			item.end = pos + 1;
+			return item;
+		};
+
+		/// Count the items in a compile-time format string, including the trailing literal
+		constexpr size_t _ctNumItems(const char *s, const size_t n) {
+			size_t count = 1u;
+			for (_CTItem item = _ctParseItem(s, n, 0u, 0u); item.f.specifier != 0; item = _ctParseItem(s, n, item.end, 0u)) ++count;
+			return count;
+		};
+
+		/// Fixed table of items parsed from a compile-time format string
+		template<size_t N>
+		struct _CTTable {
+			_CTItem items[N];
+			size_t numArgs;
+		};
+
+		template<size_t N>
+		constexpr _CTTable<N> _ctParse(const char *s, const size_t n) {
+			_CTTable<N> table {};
+			size_t pos = 0u, arg = 0u;
+			for (size_t i = 0u; i < N; ++i) {
+				table.items[i] = _ctParseItem(s, n, pos, arg);
+				pos = table.items[i].end;
+				arg += _ctNumArgs(table.items[i].f);
+			}
+			table.numArgs = arg;
+			return table;
+		};
+
+		/// The format string S parsed once by the compiler
+		template<typename S>
+		struct _CTFormat {
+			static constexpr size_t numItems = _ctNumItems(S::data(), S::size());
+			static constexpr _CTTable<numItems> table = _ctParse<numItems>(S::data(), S::size());
+		};
+		template<typename S> constexpr size_t _CTFormat<S>::numItems;
+		template<typename S> constexpr _CTTable<_CTFormat<S>::numItems> _CTFormat<S>::table;
+
+		/// The type an argument is checked as, temporaries are treated as const as they cannot be written to by %n
+		template<typename Tuple, size_t I>
+		struct _CTArg {
+			typedef typename std::tuple_element<I, typename std::decay<Tuple>::type>::type ref;
+			typedef typename std::remove_reference<ref>::type val;
+			typedef typename std::conditional<std::is_lvalue_reference<ref>::value, val, const val>::type type;
+		};
+
+		/// Declaration kinds, determines which arguments an item consumes
+		enum _CTKind { _ctLiteral, _ctPercent, _ctValue, _ctWidth, _ctPrecision, _ctWidthPrecision };
+
+		constexpr _CTKind _ctKind(const _Format &f) {
+			return (f.specifier == 0)								? _ctLiteral
+				 : (f.specifier == '%')								? _ctPercent
+				 : (f.width == -1 && f.precision == -1)				? _ctWidthPrecision
+				 : (f.width == -1)									? _ctWidth
+				 : (f.precision == -1)								? _ctPrecision
+				 :													  _ctValue;
+		};
+
+		/// Typecheck the value consumed by item I at compile time
+		template<typename S, size_t I, typename Tuple>
+		constexpr bool _ctCheckVal() {
+			return _containsChar(_CTFormat<S>::table.items[I].f.specifier, 
+				_Spec<typename _CTArg<Tuple, _CTFormat<S>::table.items[I].arg + _ctNumArgs(_CTFormat<S>::table.items[I].f) - 1u>::type>::chars());
+		};
+
+		/// Typecheck the width or precision argument at offset A from the first argument of item I at compile time
+		template<typename S, size_t I, size_t A, typename Tuple>
+		constexpr bool _ctCheckSize() {
+			return _IsSizeArg<typename _CTArg<Tuple, _CTFormat<S>::table.items[I].arg + A>::val>::value;
+		};
+
+		template<typename S, size_t I, typename Tuple>
+		inline void _ctFormatDecl(const int _line_, const char *_file_, _Buffer &ret, const size_t start, Tuple &&args, std::integral_constant<_CTKind, _ctLiteral>) {};
+
+		template<typename S, size_t I, typename Tuple>
+		inline void _ctFormatDecl(const int _line_, const char *_file_, _Buffer &ret, const size_t start, Tuple &&args, std::integral_constant<_CTKind, _ctPercent>) {
+			ret.push_back('%');
+		};
+
+		template<typename S, size_t I, typename Tuple>
+		inline void _ctFormatDecl(const int _line_, const char *_file_, _Buffer &ret, const size_t start, Tuple &&args, std::integral_constant<_CTKind, _ctValue>) {
+			static_assert(_ctCheckVal<S, I, Tuple>(), "String Format | Incorrect format specifier for type");
+			constexpr _CTItem item = _CTFormat<S>::table.items[I];
+			_formatArg(_line_, _file_, ret, item.f, _makeArg(std::get<item.arg>(std::move(args))), start);
+		};
+
+		template<typename S, size_t I, typename Tuple>
+		inline void _ctFormatDecl(const int _line_, const char *_file_, _Buffer &ret, const size_t start, Tuple &&args, std::integral_constant<_CTKind, _ctWidth>) {
+			static_assert(_ctCheckSize<S, I, 0u, Tuple>(), "String Format | Invalid width argument");
+			static_assert(_ctCheckVal<S, I, Tuple>(), "String Format | Incorrect format specifier for type");
+			constexpr _CTItem item = _CTFormat<S>::table.items[I];
+			_Format f = item.f;
+			_setWidth(f, _widthArg(_line_, _file_, std::get<item.arg>(args)));
+			_formatArg(_line_, _file_, ret, f, _makeArg(std::get<item.arg + 1u>(std::move(args))), start);
+		};
+
+		template<typename S, size_t I, typename Tuple>
+		inline void _ctFormatDecl(const int _line_, const char *_file_, _Buffer &ret, const size_t start, Tuple &&args, std::integral_constant<_CTKind, _ctPrecision>) {
+			static_assert(_ctCheckSize<S, I, 0u, Tuple>(), "String Format | Invalid precision argument");
+			static_assert(_ctCheckVal<S, I, Tuple>(), "String Format | Incorrect format specifier for type");
+			constexpr _CTItem item = _CTFormat<S>::table.items[I];
+			_Format f = item.f;
+			_setPrecision(f, _precisionArg(_line_, _file_, std::get<item.arg>(args)));
+			_formatArg(_line_, _file_, ret, f, _makeArg(std::get<item.arg + 1u>(std::move(args))), start);
+		};
+
+		template<typename S, size_t I, typename Tuple>
+		inline void _ctFormatDecl(const int _line_, const char *_file_, _Buffer &ret, const size_t start, Tuple &&args, std::integral_constant<_CTKind, _ctWidthPrecision>) {
+			static_assert(_ctCheckSize<S, I, 0u, Tuple>(), "String Format | Invalid width argument");
+			static_assert(_ctCheckSize<S, I, 1u, Tuple>(), "String Format | Invalid precision argument");
+			static_assert(_ctCheckVal<S, I, Tuple>(), "String Format | Incorrect format specifier for type");
+			constexpr _CTItem item = _CTFormat<S>::table.items[I];
+			_Format f = item.f;
+			_setWidth(f, _widthArg(_line_, _file_, std::get<item.arg>(args)));
+			_setPrecision(f, _precisionArg(_line_, _file_, std::get<item.arg + 1u>(args)));
+			_formatArg(_line_, _file_, ret, f, _makeArg(std::get<item.arg + 2u>(std::move(args))), start);
+		};
+
+		/**
+		* Write the literal segment of item I and then format the arguments of its declaration
+		* @param _line_		Pass along the debug macro __LINE__ from the call site
+		* @param _file_		Pass along the debug macro __FILE__ from the call site
+		* @param ret		The buffer to write output to
+		* @param start		The number of characters ret held when the current call started
+		* @param args		Tuple of references to all of the arguments
+		*/
+		template<typename S, size_t I, typename Tuple>
+		inline void _ctFormatItem(const int _line_, const char *_file_, _Buffer &ret, const size_t start, Tuple &&args) {
+			constexpr _CTItem item = _CTFormat<S>::table.items[I];
+			if (item.litE != item.litS) ret.append(S::data() + item.litS, item.litE - item.litS);
+			_ctFormatDecl<S, I>(_line_, _file_, ret, start, std::forward<Tuple>(args), std::integral_constant<_CTKind, _ctKind(item.f)>());
+		};
+
+		template<typename S, typename Tuple, size_t ...I>
+		inline void _ctFormat(const int _line_, const char *_file_, _Buffer &ret, Tuple &&args, std::index_sequence<I...>) {
+			const size_t start = ret.written();
+			const int expand[] = { (_ctFormatItem<S, I>(_line_, _file_, ret, start, std::forward<Tuple>(args)), 0)... };
+			(void) expand;
+		};
+
+		/// Compile-time equivalent of _writeField
+		template<size_t N>
+		constexpr void _ctWriteField(static_string<N> &ret, const _Format &f,
+			const char *prefix, const size_t prefixLen,
+			const char *body, const size_t bodyLen,
+			const size_t zeros, const bool numeric) {
+
+			const size_t len = prefixLen + zeros + bodyLen;
+			const size_t padding = (f.width > 0 && (size_t) f.width > len) ? ((size_t) f.width - len) : 0u;
+			const bool zeroPad = !f.leftJustify && f.padZeros && numeric;
+			if (!f.leftJustify && !zeroPad) ret.append(padding, f.padZeros ? '0' : ' ');
+			ret.append(prefix, prefixLen);
+			ret.append(zeros + (zeroPad ? padding : 0u), '0');
+			ret.append(body, bodyLen);
+			if (f.leftJustify) ret.append(padding, ' ');
+		};
+
+		/// Compile-time equivalent of _formatInteger
+		template<size_t N>
+		constexpr void _ctFormatInteger(static_string<N> &ret, const _Format &f, const bool negative, unsigned long long val) {
+			const unsigned int base = (f.specifier == 'o') ? 8u : ((f.specifier == 'x' || f.specifier == 'X') ? 16u : 10u);
+			const char *digits = (f.specifier == 'X') ? "0123456789ABCDEF" : "0123456789abcdef";
+
+			/// Digits are generated backwards from the end of the buffer
+			char buf[24] = {};
+			size_t pos = sizeof(buf);
+			for (; val != 0u; val /= base) buf[--pos] = digits[val % base];
+			const size_t len = sizeof(buf) - pos;
+
+			char prefix[2] = {};
+			size_t prefixLen = 0;
+			if (negative)								prefix[prefixLen++] = '-';
+			else if (f.forceSign && base == 10u && f.specifier != 'u') prefix[prefixLen++] = '+';
+			if (f.forceLong && base == 16u && len > 0) {
+				prefix[prefixLen++] = '0';
+				prefix[prefixLen++] = f.specifier;
+			}
+
+			/// Precision is the minimum number of digits, zero with precision 0 has no digits
+			size_t precision = (f.precision >= 0) ? (size_t) f.precision : 1u;
+			if (f.forceLong && base == 8u && precision <= len) precision = len + 1u;
+			const size_t zeros = (precision > len) ? (precision - len) : 0u;
+
+			/// The 0 flag is ignored when a precision is given
+			_Format field = f;
+			if (f.precision >= 0) field.padZeros = false;
+			_ctWriteField(ret, field, prefix, prefixLen, buf + pos, len, zeros, true);
+		};
+
+		template<typename T, typename U, size_t N>
+		constexpr void _ctFormatSigned(static_string<N> &ret, const _Format &f, const T val) {
+			if (f.specifier == 'd' || f.specifier == 'i') {
+				const bool negative = (val < 0);
+				_ctFormatInteger(ret, f, negative, negative ? (0ull - (unsigned long long) val) : (unsigned long long) val);
+			}
+			else {
+				_ctFormatInteger(ret, f, false, (unsigned long long) (U) val);
+			}
+		};
+
+		/// Compile-time equivalent of _formatArg for the types static_format supports
+		template<size_t N>
+		constexpr void _ctStaticArg(static_string<N> &ret, const _Format &f, const int val)					{ _ctFormatSigned<int, unsigned int>(ret, f, val); };
+		template<size_t N>
+		constexpr void _ctStaticArg(static_string<N> &ret, const _Format &f, const short int val)				{ _ctFormatSigned<short int, unsigned short int>(ret, f, val); };
+		template<size_t N>
+		constexpr void _ctStaticArg(static_string<N> &ret, const _Format &f, const long int val)				{ _ctFormatSigned<long int, unsigned long int>(ret, f, val); };
+		template<size_t N>
+		constexpr void _ctStaticArg(static_string<N> &ret, const _Format &f, const long long int val)			{ _ctFormatSigned<long long int, unsigned long long int>(ret, f, val); };
+		template<size_t N>
+		constexpr void _ctStaticArg(static_string<N> &ret, const _Format &f, const unsigned int val)			{ _ctFormatInteger(ret, f, false, val); };
+		template<size_t N>
+		constexpr void _ctStaticArg(static_string<N> &ret, const _Format &f, const unsigned short int val)		{ _ctFormatInteger(ret, f, false, val); };
+		template<size_t N>
+		constexpr void _ctStaticArg(static_string<N> &ret, const _Format &f, const unsigned long int val)		{ _ctFormatInteger(ret, f, false, val); };
+		template<size_t N>
+		constexpr void _ctStaticArg(static_string<N> &ret, const _Format &f, const unsigned long long int val)	{ _ctFormatInteger(ret, f, false, val); };
+		template<size_t N>
+		constexpr void _ctStaticArg(static_string<N> &ret, const _Format &f, const char val)					{ _ctWriteField(ret, f, "", 0u, &val, 1u, 0u, false); };
+		template<size_t N>
+		constexpr void _ctStaticArg(static_string<N> &ret, const _Format &f, const unsigned char val) {
+			const char c = (char) val;
+			_ctWriteField(ret, f, "", 0u, &c, 1u, 0u, false);
+		};
+		template<size_t N>
+		constexpr void _ctStaticArg(static_string<N> &ret, const _Format &f, const bool val) {
+			const char *text = (f.specifier == 'b') ? (f.forceLong ? (val ? "true" : "false") : (val ? "1" : "0"))
+												   : (f.forceLong ? (val ? "TRUE" : "FALSE") : (val ? "T" : "F"));
+			_ctWriteField(ret, f, "", 0u, text, f.forceLong ? (val ? 4u : 5u) : 1u, 0u, false);
+		};
+		/// Text up to the first nul, never past the end of the array
+		template<size_t N>
+		constexpr void _ctStaticText(static_string<N> &ret, const _Format &f, const char *s, const size_t size) {
+			size_t len = 0u;
+			while (len < size && s[len] != '\0') ++len;
+			if (f.precision > 0 && (size_t) f.precision < len) len = (size_t) f.precision;
+			_ctWriteField(ret, f, "", 0u, s, len, 0u, false);
+		};
+		template<size_t N, size_t M>
+		constexpr void _ctStaticArg(static_string<N> &ret, const _Format &f, const char (&val)[M])				{ _ctStaticText(ret, f, val, M); };
+		template<size_t N, size_t M>
+		constexpr void _ctStaticArg(static_string<N> &ret, const _Format &f, const static_string<M> &val)		{ _ctStaticText(ret, f, val.data(), val.size()); };
+
+		/// Most chars static_format writes for an argument of type T before width and precision, 0 for unsupported types
+		template<typename T> struct _CTStaticSize					{ static constexpr size_t value = 0u; static constexpr bool integer = false; };
+		template<typename T> struct _CTStaticSize<const T>			: _CTStaticSize<T> {};
+		template<> struct _CTStaticSize<char>						{ static constexpr size_t value = 1u; static constexpr bool integer = false; };
+		template<> struct _CTStaticSize<unsigned char>				{ static constexpr size_t value = 1u; static constexpr bool integer = false; };
+		template<> struct _CTStaticSize<bool>						{ static constexpr size_t value = 5u; static constexpr bool integer = false; };
+		template<size_t M> struct _CTStaticSize<char[M]>			{ static constexpr size_t value = M; static constexpr bool integer = false; };
+		template<size_t M> struct _CTStaticSize<static_string<M>>	{ static constexpr size_t value = M; static constexpr bool integer = false; };
+		/// Integers take at most one octal digit per 3 bits, plus a sign or "0x"
+		template<typename T> struct _CTStaticInt					{ static constexpr size_t value = (sizeof(T) * CHAR_BIT + 2u) / 3u + 2u; static constexpr bool integer = true; };
+		template<> struct _CTStaticSize<int>						: _CTStaticInt<int> {};
+		template<> struct _CTStaticSize<short int>					: _CTStaticInt<short int> {};
+		template<> struct _CTStaticSize<long int>					: _CTStaticInt<long int> {};
+		template<> struct _CTStaticSize<long long int>				: _CTStaticInt<long long int> {};
+		template<> struct _CTStaticSize<unsigned int>				: _CTStaticInt<unsigned int> {};
+		template<> struct _CTStaticSize<unsigned short int>			: _CTStaticInt<unsigned short int> {};
+		template<> struct _CTStaticSize<unsigned long int>			: _CTStaticInt<unsigned long int> {};
+		template<> struct _CTStaticSize<unsigned long long int>		: _CTStaticInt<unsigned long long int> {};
+
+		/// Most chars static_format writes for item I, typechecking it on the way
+		template<typename S, size_t I, typename Tuple>
+		constexpr size_t _ctStaticItemSize(std::integral_constant<_CTKind, _ctLiteral>) {
+			return _CTFormat<S>::table.items[I].litE - _CTFormat<S>::table.items[I].litS;
+		};
+
+		template<typename S, size_t I, typename Tuple>
+		constexpr size_t _ctStaticItemSize(std::integral_constant<_CTKind, _ctPercent>) {
+			return _CTFormat<S>::table.items[I].litE - _CTFormat<S>::table.items[I].litS + 1u;
+		};
+
+		template<typename S, size_t I, typename Tuple>
+		constexpr size_t _ctStaticItemSize(std::integral_constant<_CTKind, _ctValue>) {
+			constexpr _CTItem item = _CTFormat<S>::table.items[I];
+			typedef _CTStaticSize<typename _CTArg<Tuple, item.arg>::val> Size;
+			static_assert(Size::value != 0u, "String Format | static_format only supports integers, chars, bools and char arrays");
+			static_assert(_ctCheckVal<S, I, Tuple>(), "String Format | Incorrect format specifier for type");
+			static_assert(_containsChar(item.f.specifier, "diuoxXcbBs"), "String Format | static_format only supports 'd', 'i', 'u', 'o', 'x', 'X', 'c', 'b', 'B' and 's'");
+
+			/// Precision only adds digits to integers, it truncates strings
+			const size_t precision = (item.f.precision > 0) ? (size_t) item.f.precision : 0u;
+			const size_t body = Size::integer ? std::max(Size::value, precision + 2u) : Size::value;
+			const size_t width = (item.f.width > 0) ? (size_t) item.f.width : 0u;
+			return (item.litE - item.litS) + std::max(body, width);
+		};
+
+		/// '*' widths and precisions are not known until the call, so can not size the result
+		template<typename S, size_t I, typename Tuple, _CTKind K>
+		constexpr size_t _ctStaticItemSize(std::integral_constant<_CTKind, K>) {
+			static_assert(K != _ctWidth && K != _ctPrecision && K != _ctWidthPrecision, "String Format | static_format needs widths and precisions in the format string");
+			return 0u;
+		};
+
+		template<typename S, typename Tuple, size_t ...I>
+		constexpr size_t _ctStaticSize(std::index_sequence<I...>) {
+			const size_t sizes[] = { _ctStaticItemSize<S, I, Tuple>(std::integral_constant<_CTKind, _ctKind(_CTFormat<S>::table.items[I].f)>())... };
+			size_t size = 0u;
+			for (const size_t item : sizes) size += item;
+			return size;
+		};
+
+		/// Capacity of the static_string for formatting Args with S
+		template<typename S, typename ...Args>
+		struct _CTStatic {
+			static_assert(_CTFormat<S>::table.numArgs <= sizeof...(Args), "String Format | Not enough arguments");
+			static_assert(_CTFormat<S>::table.numArgs >= sizeof...(Args), "String Format | Unused arguments");
+			static constexpr size_t capacity = _ctStaticSize<S, std::tuple<const Args&...>>(std::make_index_sequence<_CTFormat<S>::numItems>());
+		};
+
+		template<typename S, size_t I, size_t N, typename Tuple>
+		constexpr void _ctStaticItem(static_string<N> &ret, const Tuple &args, std::integral_constant<_CTKind, _ctLiteral>) {};
+
+		template<typename S, size_t I, size_t N, typename Tuple>
+		constexpr void _ctStaticItem(static_string<N> &ret, const Tuple &args, std::integral_constant<_CTKind, _ctPercent>) {
+			ret.append(1u, '%');
+		};
+
+		template<typename S, size_t I, size_t N, typename Tuple>
+		constexpr void _ctStaticItem(static_string<N> &ret, const Tuple &args, std::integral_constant<_CTKind, _ctValue>) {
+			constexpr _CTItem item = _CTFormat<S>::table.items[I];
+			_ctStaticArg(ret, item.f, std::get<item.arg>(args));
+		};
+
+		template<typename S, size_t N, typename Tuple, size_t ...I>
+		constexpr void _ctStaticFormat(static_string<N> &ret, const Tuple &args, std::index_sequence<I...>) {
+			const int expand[] = { (ret.append(S::data() + _CTFormat<S>::table.items[I].litS, _CTFormat<S>::table.items[I].litE - _CTFormat<S>::table.items[I].litS),
+				_ctStaticItem<S, I>(ret, args, std::integral_constant<_CTKind, _ctKind(_CTFormat<S>::table.items[I].f)>()), 0)... };
+			(void) expand;
+		};
+#endif
+
+		/**
+		* Format into any buffer, the format string may be a runtime string or wrapped by fmt_lit("...")
+		* @param _line_		Pass along the debug macro __LINE__ from the call site
+		* @param _file_		Pass along the debug macro __FILE__ from the call site
+		* @param ret		The buffer to write output to
+		* @param fmt		The format string to use
+		* @param ...args	The set of arguments to insert into fmt
+		*/
+		template<typename ...Args>
+		inline void _formatTo(const int _line_, const char *_file_, _Buffer &ret, const std::string &fmt, Args &&...args) {
+			const _Arg argArray[] = { _makeArg(std::forward<Args>(args))..., _Arg() };
+			_vformat(_line_, _file_, ret, fmt.data(), fmt.data() + fmt.size(), argArray, sizeof...(Args));
+		};
+
+		/// Literals and char pointers are formatted in place rather than being copied into a std::string
+		template<typename ...Args>
+		inline void _formatTo(const int _line_, const char *_file_, _Buffer &ret, const char *fmt, Args &&...args) {
+			const _Arg argArray[] = { _makeArg(std::forward<Args>(args))..., _Arg() };
+			_vformat(_line_, _file_, ret, fmt, fmt + std::strlen(fmt), argArray, sizeof...(Args));
+		};
+#ifdef STR_EXT_CPP17
+		template<typename ...Args>
+		inline void _formatTo(const int _line_, const char *_file_, _Buffer &ret, const std::string_view fmt, Args &&...args) {
+			const _Arg argArray[] = { _makeArg(std::forward<Args>(args))..., _Arg() };
+			_vformat(_line_, _file_, ret, fmt.data(), fmt.data() + fmt.size(), argArray, sizeof...(Args));
+		};
+#endif
+#ifdef STR_EXT_CPP14
+		template<typename S, typename ...Args>
+		inline typename std::enable_if<std::is_base_of<_Literal, S>::value>::type
+		_formatTo(const int _line_, const char *_file_, _Buffer &ret, const S &fmt, Args &&...args) {
+			static_assert(_CTFormat<S>::table.numArgs <= sizeof...(Args), "String Format | Not enough arguments");
+			static_assert(_CTFormat<S>::table.numArgs >= sizeof...(Args), "String Format | Unused arguments");
+			_ctFormat<S>(_line_, _file_, ret, std::forward_as_tuple(std::forward<Args>(args)...), 
+				std::make_index_sequence<_CTFormat<S>::numItems>());
+		};
+#endif
+
+		template<typename Fmt, typename ...Args>
+		inline void _Writer::format(const Fmt &fmt, Args &&...args) {
+			_formatTo(-1, nullptr, _ret, fmt, std::forward<Args>(args)...);
+		};
+
+		/// Round n up to a multiple of align, a power of two
+		inline size_t _alignUp(const size_t n, const size_t align) {
+			return (n + align - 1u) & ~(align - 1u);
+		};
+
+		/// Size and alignment of the value an argument refers to, 0 when there is nothing to copy as ptr is the value itself
+		inline size_t _argBytes(const _Arg &arg, size_t &align) {
+			align = 1u;
+			switch (arg.type) {
+			case _argInt:			align = alignof(int);						return sizeof(int);
+			case _argShort:			align = alignof(short int);					return sizeof(short int);
+			case _argLong:			align = alignof(long int);					return sizeof(long int);
+			case _argLongLong:		align = alignof(long long int);				return sizeof(long long int);
+			case _argUInt:			align = alignof(unsigned int);				return sizeof(unsigned int);
+			case _argUShort:		align = alignof(unsigned short int);		return sizeof(unsigned short int);
+			case _argULong:			align = alignof(unsigned long int);			return sizeof(unsigned long int);
+			case _argULongLong:		align = alignof(unsigned long long int);	return sizeof(unsigned long long int);
+			case _argFloat:			align = alignof(float);						return sizeof(float);
+			case _argDouble:		align = alignof(double);					return sizeof(double);
+			case _argLongDouble:	align = alignof(long double);				return sizeof(long double);
+			case _argChar:			return sizeof(char);
+			case _argUChar:			return sizeof(unsigned char);
+			case _argBool:			return sizeof(bool);
+			case _argText:			return arg.size;
+			case _argBinary:		return arg.size;
+			default:				return 0u;
+			}
+		};
+
+		/**
+		* Turn an argument into one which can be copied into a deferred record. Strings become _argText over their chars,
+		* a null char* is kept as it is, and types written by str::formatter<T> are formatted now into stash.
+		* @param _line_		Pass along the debug macro __LINE__ from the call site
+		* @param _file_		Pass along the debug macro __FILE__ from the call site
+		* @param arg		The argument, modified in place
+		* @param stash		Text of formatted arguments, arg.ptr holds an offset into it until _resolveStash is called
+		*/
+		inline void _captureArg(const int _line_, const char *_file_, _Arg &arg, std::string &stash) {
+			const char *s = static_cast<const char*>(arg.ptr);
+			switch (arg.type) {
+			case _argString: {
+				const std::string &str = *static_cast<const std::string*>(arg.ptr);
+				arg.ptr = str.data();
+				arg.size = str.size();
+				break;
+			}
+			case _argCString:
+				/// Captured as text, so '%p' of a char* is rejected rather than printing the address of the copy
+				arg.specs = "s";
+				if (s == nullptr) return;
+				arg.size = std::strlen(s);
+				break;
+			case _argCharArray: {
+				const void *end = std::memchr(s, '\0', arg.size);
+				if (end != nullptr) arg.size = (size_t) (static_cast<const char*>(end) - s);
+				break;
+			}
+#ifdef STR_EXT_CPP17
+			case _argStringView: {
+				const std::string_view &str = *static_cast<const std::string_view*>(arg.ptr);
+				arg.ptr = str.data();
+				arg.size = str.size();
+				break;
+			}
+#endif
+			case _argCustom: {
+				const size_t offset = stash.size();
+				_StringBuffer ret(stash);
+				arg.custom(_line_, _file_, ret, _Format(), arg.ptr);
+				ret.flush();
+				arg.ptr = reinterpret_cast<const void*>(offset);
+				arg.size = stash.size() - offset;
+				arg.type = _argText;
+				return;		/// arg.custom stays set to mark that ptr is an offset into stash
+			}
+			default:
+				return;
+			}
+			arg.type = _argText;
+		};
+
+		/// Point formatted arguments at their text once the stash has stopped growing
+		inline void _resolveStash(_Arg &arg, const std::string &stash) {
+			if (arg.type != _argText || arg.custom == nullptr) return;
+			arg.ptr = stash.data() + reinterpret_cast<size_t>(arg.ptr);
+			arg.custom = nullptr;
+		};
+
+		/// Start of each deferred record, followed by the _Arg array, the argument values, then a copy of the format string if it needed one
+		struct _DeferredHeader {
+			size_t size;		/// Bytes taken by the record including padding
+			size_t numArgs;		/// (size_t) -1 marks padding at the end of the ring, only size is valid
+			const char *fmt;	/// The format string, or its offset in the record when copied
+			size_t fmtSize;
+			bool fmtCopied;
+			int line;
+			const char *file;
+		};
+
+		/// Single producer single consumer ring of deferred records, one per thread using a str::deferred_formatter
+		class _DeferredRing {
+		public:
+			/// capacity must be a power of two and a multiple of sizeof(std::max_align_t)
+			explicit _DeferredRing(const size_t capacity) :
+				_storage(new std::max_align_t[capacity / sizeof(std::max_align_t)]),
+				_capacity(capacity), _head(0u), _reserved(0u), _tail(0u), _read(0u), _orphaned(false) {};
+
+			/**
+			* Reserve n contiguous bytes, waiting for the consumer while the ring is full
+			* @param n			Size of the record, a multiple of sizeof(std::max_align_t)
+			* @return			Returns where to write the record, or nullptr when it could never fit
+			*/
+			inline char* reserve(const size_t n) {
+				if (n > _capacity / 2u) return nullptr;
+				const size_t head = _head.load(std::memory_order_relaxed);
+				const size_t pos = head & (_capacity - 1u);
+				const size_t contiguous = _capacity - pos;
+				const size_t needed = (n <= contiguous) ? n : contiguous + n;
+				while (_capacity - (head - _tail.load(std::memory_order_acquire)) < needed) std::this_thread::yield();
+
+				char *ptr = data() + pos;
+				if (n > contiguous) {
+					/// Pad out the end of the ring and start the record from the beginning
+					_DeferredHeader *pad = reinterpret_cast<_DeferredHeader*>(ptr);
+					pad->size = contiguous;
+					pad->numArgs = (size_t) -1;
+					ptr = data();
+				}
+				_reserved = head + needed;
+				return ptr;
+			};
+
+			/// Publish the last reserved record to the consumer, sequentially consistent so a parking consumer cannot miss it
+			inline void commit() { _head.store(_reserved, std::memory_order_seq_cst); };
+
+			/// Wait until the consumer has written out everything published so far
+			inline void drain() const {
+				const size_t head = _head.load(std::memory_order_relaxed);
+				while (_tail.load(std::memory_order_acquire) != head) std::this_thread::yield();
+			};
+
+			inline char* data() { return reinterpret_cast<char*>(_storage.get()); };
+			inline size_t capacity() const { return _capacity; };
+
+			std::unique_ptr<std::max_align_t[]> _storage;
+			const size_t _capacity;
+			std::atomic<size_t> _head;		/// Published by the producer
+			size_t _reserved;				/// Producer only
+			char _pad[64];					/// Keeps the producer and consumer counters off each others cache line
+			std::atomic<size_t> _tail;		/// Released by the consumer once records have been written out
+			size_t _read;					/// Consumer only
+			std::atomic<bool> _orphaned;	/// The producing thread has exited
+		};
+
+		/**
+		* Copy the record for one call into the ring
+		* @param ring		The calling thread's ring
+		* @param _line_		The debug macro __LINE__ from the call site
+		* @param _file_		The debug macro __FILE__ from the call site
+		* @param fmt		The format string
+		* @param fmtSize	Length of fmt
+		* @param copyFmt	Copy fmt into the record, otherwise only the pointer is kept
+		* @param args		The arguments, already passed through _captureArg and _resolveStash
+		* @param numArgs	The number of arguments
+		* @return			Returns false if the record is too large for the ring
+		*/
+		inline bool _pushDeferred(_DeferredRing &ring, const int _line_, const char *_file_,
+			const char *fmt, const size_t fmtSize, const bool copyFmt,
+			_Arg *args, const size_t numArgs) {
+
+			const size_t argsOffset = _alignUp(sizeof(_DeferredHeader), alignof(_Arg));
+			const size_t valuesOffset = argsOffset + (numArgs + 1u) * sizeof(_Arg);
+			size_t size = valuesOffset;
+			for (size_t i = 0; i < numArgs; ++i) {
+				size_t align;
+				const size_t bytes = _argBytes(args[i], align);
+				if (bytes != 0u) size = _alignUp(size, align) + bytes;
+			}
+			const size_t fmtOffset = size;
+			if (copyFmt) size += fmtSize;
+			size = _alignUp(size, sizeof(std::max_align_t));
+
+			char *rec = ring.reserve(size);
+			if (rec == nullptr) return false;
+
+			/// Values are copied in after the argument array and their pointers become offsets into the record
+			size_t offset = valuesOffset;
+			for (size_t i = 0; i < numArgs; ++i) {
+				size_t align;
+				const size_t bytes = _argBytes(args[i], align);
+				if (bytes == 0u) continue;
+				offset = _alignUp(offset, align);
+				std::memcpy(rec + offset, args[i].ptr, bytes);
+				args[i].ptr = reinterpret_cast<const void*>(offset);
+				offset += bytes;
+			}
+			std::memcpy(rec + argsOffset, args, (numArgs + 1u) * sizeof(_Arg));
+			if (copyFmt) std::memcpy(rec + fmtOffset, fmt, fmtSize);
+
+			_DeferredHeader *header = reinterpret_cast<_DeferredHeader*>(rec);
+			header->size = size;
+			header->numArgs = numArgs;
+			header->fmt = copyFmt ? reinterpret_cast<const char*>(fmtOffset) : fmt;
+			header->fmtSize = fmtSize;
+			header->fmtCopied = copyFmt;
+			header->line = _line_;
+			header->file = _file_;
+			ring.commit();
+			return true;
+		};
+
+		/**
+		* Format one deferred record
+		* @param ret		The buffer to write output to
+		* @param rec		The record, its argument pointers are fixed up in place
+		*/
+		inline void _formatDeferred(_Buffer &ret, char *rec) {
+			const _DeferredHeader &header = *reinterpret_cast<const _DeferredHeader*>(rec);
+			_Arg *args = reinterpret_cast<_Arg*>(rec + _alignUp(sizeof(_DeferredHeader), alignof(_Arg)));
+			for (size_t i = 0; i < header.numArgs; ++i) {
+				size_t align;
+				if (_argBytes(args[i], align) != 0u) args[i].ptr = rec + reinterpret_cast<size_t>(args[i].ptr);
+			}
+			const char *fmt = header.fmtCopied ? rec + reinterpret_cast<size_t>(header.fmt) : header.fmt;
+			_vformat(header.line, header.file, ret, fmt, fmt + header.fmtSize, args, header.numArgs);
+		};
+
+		/// A thread's ring for one str::deferred_formatter, lets the consumer release the ring once the thread exits
+		struct _DeferredSlot {
+			size_t id;
+			std::shared_ptr<_DeferredRing> ring;
+
+			_DeferredSlot(const size_t id, std::shared_ptr<_DeferredRing> ring) : id(id), ring(std::move(ring)) {};
+			_DeferredSlot(_DeferredSlot &&other) : id(other.id), ring(std::move(other.ring)) {};
+			_DeferredSlot& operator=(_DeferredSlot &&other) {
+				if (ring) ring->_orphaned.store(true, std::memory_order_release);
+				id = other.id;
+				ring = std::move(other.ring);
+				return *this;
+			};
+			~_DeferredSlot() { if (ring) ring->_orphaned.store(true, std::memory_order_release); };
+		};
+
+		inline std::vector<_DeferredSlot>& _deferredSlots() {
+			static thread_local std::vector<_DeferredSlot> slots;
+			return slots;
+		};
+
+		/// Text of formatted arguments, kept between calls so steady state capturing does not allocate
+		inline std::string& _deferredStash() {
+			static thread_local std::string stash;
+			return stash;
+		};
+
+		/**
+		* One argument of str::cat or element of str::join, measured in a first pass so the output is allocated once.
+		* Text is referenced where it is, numbers, chars and bools are written to the piece's own storage,
+		* and other types are formatted once into a scratch buffer shared by all of the pieces.
+		*/
+		struct _CatPiece {
+			enum Kind { text, local, deferred };
+
+			Kind kind;
+			const char *ptr;		/// Start of text pieces
+			size_t size;
+			size_t offset;			/// Start of deferred pieces in the scratch buffer
+			_Format f;				/// Declaration used for local and deferred pieces
+			char store[32];			/// Long enough for any integer and for '%g' of any float
+
+			/// Where the chars are, scratch is the buffer the piece was measured with
+			inline const char* data(const _Buffer &scratch) const {
+				return (kind == local) ? store : ((kind == deferred) ? scratch.data() + offset : ptr);
+			};
+		};
+
+		/// Types written by str::formatter<T> or operator<<, pointers and bytes, which can only be measured by formatting them
+		inline bool _catDeferred(const _Arg &arg, _Format &f) {
+			switch (arg.type) {
+			case _argPointer:	f.specifier = 'p'; return true;
+			case _argBinary:	f.specifier = 'h'; return true;
+			case _argCustom:	f.specifier = 's'; return true;
+			default:			return false;
+			}
+		};
+
+		/// Integers are written straight into the piece, sized by the same digit count as '%d'
+		template<typename T>
+		inline void _catInteger(_CatPiece &piece, const T val) {
+			const bool negative = (val < 0);
+			const unsigned long long mag = negative ? (0ull - (unsigned long long) val) : (unsigned long long) val;
+			const size_t digits = std::max(_countDigits(mag), 1u);
+			piece.kind = _CatPiece::local;
+			piece.size = digits + (negative ? 1u : 0u);
+			piece.store[0] = '-';
+			piece.store[piece.size - 1u] = '0';
+			_writeDecimal(piece.store + piece.size, mag);
+		};
+
+		/**
+		* Measure an argument, formatted as '%s', '%d' / '%u', '%g', '%c', '%#b' or '%p' for its type
+		* @param piece		Filled in with the size and where the chars come from
+		* @param arg		The argument
+		* @param scratch	Types which can only be measured by formatting them are formatted into here, once
+		*/
+		inline void _catMeasure(_CatPiece &piece, const _Arg &arg, _Buffer &scratch) {
+			piece.kind = _CatPiece::text;
+			piece.f = _Format();
+			if (_catDeferred(arg, piece.f)) {
+				piece.kind = _CatPiece::deferred;
+				piece.offset = scratch.written();
+				_formatArg(-1, nullptr, scratch, piece.f, arg, 0u);
+				piece.size = scratch.written() - piece.offset;
+				return;
+			}
+			switch (arg.type) {
+			case _argString: {
+				const std::string &s = *static_cast<const std::string*>(arg.ptr);
+				piece.ptr = s.data();
+				piece.size = s.size();
+				return;
+			}
+			case _argCString:
+				piece.ptr = (arg.ptr != nullptr) ? static_cast<const char*>(arg.ptr) : "(null)";
+				piece.size = std::strlen(piece.ptr);
+				return;
+			case _argCharArray: {
+				/// Up to the first nul, never past the end of the array
+				piece.ptr = static_cast<const char*>(arg.ptr);
+				const void *end = std::memchr(piece.ptr, '\0', arg.size);
+				piece.size = (end != nullptr) ? (size_t) (static_cast<const char*>(end) - piece.ptr) : arg.size;
+				return;
+			}
+#ifdef STR_EXT_CPP17
+			case _argStringView: {
+				const std::string_view &s = *static_cast<const std::string_view*>(arg.ptr);
+				piece.ptr = s.data();
+				piece.size = s.size();
+				return;
+			}
+#endif
+			case _argText:
+				piece.ptr = static_cast<const char*>(arg.ptr);
+				piece.size = arg.size;
+				return;
+			case _argBool:
+				piece.ptr = *static_cast<const bool*>(arg.ptr) ? "true" : "false";
+				piece.size = std::strlen(piece.ptr);
+				return;
+			case _argInt:			_catInteger(piece, *static_cast<const int*>(arg.ptr)); return;
+			case _argShort:			_catInteger(piece, *static_cast<const short int*>(arg.ptr)); return;
+			case _argLong:			_catInteger(piece, *static_cast<const long int*>(arg.ptr)); return;
+			case _argLongLong:		_catInteger(piece, *static_cast<const long long int*>(arg.ptr)); return;
+			case _argUInt:			_catInteger(piece, *static_cast<const unsigned int*>(arg.ptr)); return;
+			case _argUShort:		_catInteger(piece, *static_cast<const unsigned short int*>(arg.ptr)); return;
+			case _argULong:			_catInteger(piece, *static_cast<const unsigned long int*>(arg.ptr)); return;
+			case _argULongLong:		_catInteger(piece, *static_cast<const unsigned long long int*>(arg.ptr)); return;
+			case _argFloat: case _argDouble: case _argLongDouble:
+				piece.f.specifier = 'g';
+				break;
+			case _argChar:
+			case _argUChar:
+				piece.kind = _CatPiece::local;
+				piece.store[0] = *static_cast<const char*>(arg.ptr);
+				piece.size = 1u;
+				return;
+			default:
+				piece.ptr = "";
+				piece.size = 0u;
+				return;
+			}
+
+			piece.kind = _CatPiece::local;
+			_IteratorBuffer<char*> ret(piece.store);
+			_formatArg(-1, nullptr, ret, piece.f, arg, 0u);
+			piece.size = ret.size();
+		};
+
+		/**
+		* Concatenate type erased arguments, measuring them all before the one allocation. Every argument is formatted
+		* exactly once, types only measurable by formatting them go to a stack buffer which spills to the heap past 256 chars.
+		*/
+		inline std::string _vcat(const _Arg *args, _CatPiece *pieces, const size_t numArgs) {
+			_MemoryBuffer<256> scratch;
+			size_t total = 0;
+			for (size_t i = 0; i < numArgs; ++i) {
+				_catMeasure(pieces[i], args[i], scratch);
+				total += pieces[i].size;
+			}
+			std::string ret;
+			if (total == 0u) return ret;
+			ret.resize(total);
+			char *out = &(ret[0]);
+			for (size_t i = 0; i < numArgs; ++i) {
+				std::memcpy(out, pieces[i].data(scratch), pieces[i].size);
+				out += pieces[i].size;
+			}
+			return ret;
+		};
+
+		/**
+		* Join the elements of a range with a separator, measuring every element before the one allocation
+		* @param begin		Iterator to the first element, the range is walked twice
+		* @param end		Iterator past the last element
+		* @param sep		The separator text
+		* @param sepSize	Length of the separator
+		* @return			Returns the joined string
+		*/
+		template<typename It>
+		inline std::string _join(const It begin, const It end, const char *sep, const size_t sepSize) {
+			if (begin == end) return std::string();
+
+			/// Every element has the same type, so either all of them or none can only be measured by formatting them.
+			/// Those are formatted once, with the separators, into a stack buffer which is then copied
+			_Format f;
+			if (_catDeferred(_makeArg(*begin), f)) {
+				_MemoryBuffer<256> scratch;
+				for (It it = begin; it != end; ++it) {
+					if (it != begin) scratch.append(sep, sepSize);
+					_formatArg(-1, nullptr, scratch, f, _makeArg(*it), 0u);
+				}
+				return std::string(scratch.data(), scratch.size());
+			}
+
+			_CatPiece piece;
+			_CountingBuffer count;
+			size_t total = 0, elements = 0;
+			for (It it = begin; it != end; ++it, ++elements) {
+				_catMeasure(piece, _makeArg(*it), count);
+				total += piece.size;
+			}
+			total += sepSize * (elements - 1u);
+
+			std::string ret;
+			if (total == 0u) return ret;
+			ret.resize(total);
+			char *out = &(ret[0]);
+			for (It it = begin; it != end; ++it) {
+				if (it != begin) {
+					std::memcpy(out, sep, sepSize);
+					out += sepSize;
+				}
+				const auto &elem = *it;
+				_catMeasure(piece, _makeArg(elem), count);
+				std::memcpy(out, piece.data(count), piece.size);
+				out += piece.size;
+			}
+			return ret;
+		};
+
+		/// Set of delimiter chars for str::split, small sets are compared directly by the SIMD kernels, larger ones go through the table
+		struct _DelimSet {
+			static const size_t maxSIMD = 8u;
+
+			explicit _DelimSet(const char *delims, const size_t n) : count(n) {
+				std::memset(table, 0, sizeof(table));
+				for (size_t i = 0; i < n; ++i) {
+					table[(unsigned char) delims[i]] = 1u;
+					if (i < maxSIMD) chars[i] = delims[i];
+				}
+			};
+
+			inline bool contains(const char c) const { return table[(unsigned char) c] != 0u; };
+
+			char chars[maxSIMD];
+			size_t count;
+			unsigned char table[256];
+		};
+
+		inline const char* _findAnyScalar(const char *pos, const char *end, const _DelimSet &set) {
+			while (pos != end && !set.contains(*pos)) ++pos;
+			return pos;
+		};
+
+		inline const char* _findOneScalar(const char *pos, const char *end, const _DelimSet &set) {
+			const void *found = std::memchr(pos, set.chars[0], (size_t) (end - pos));
+			return (found != nullptr) ? static_cast<const char*>(found) : end;
+		};
+
+#ifdef STR_EXT_X86
+		/// Index of the lowest set bit of a non zero mask
+		inline unsigned int _lowestBit(const unsigned int mask) {
+#if defined(_MSC_VER) && !defined(__clang__)
+			unsigned long index;
+			_BitScanForward(&index, mask);
+			return (unsigned int) index;
+#else
+			return (unsigned int) __builtin_ctz(mask);
+#endif
+		};
+
+		/// Compare 16 chars at a time against each delimiter, the first match is the lowest bit of the combined mask
+		STR_EXT_TARGET("sse2")
+		inline const char* _findAnySSE2(const char *pos, const char *end, const _DelimSet &set) {
+			__m128i delims[_DelimSet::maxSIMD];
+			for (size_t i = 0; i < set.count; ++i) delims[i] = _mm_set1_epi8(set.chars[i]);
+			for (; end - pos >= 16; pos += 16) {
+				const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos));
+				__m128i match = _mm_cmpeq_epi8(v, delims[0]);
+				for (size_t i = 1; i < set.count; ++i) match = _mm_or_si128(match, _mm_cmpeq_epi8(v, delims[i]));
+				const unsigned int mask = (unsigned int) _mm_movemask_epi8(match);
+				if (mask != 0u) return pos + _lowestBit(mask);
+			}
+			return _findAnyScalar(pos, end, set);
+		};
+
+		/// Compare 32 chars at a time, movemask keeps the lanes in order so the lowest bit is still the first match
+		STR_EXT_TARGET("avx2")
+		inline const char* _findAnyAVX2(const char *pos, const char *end, const _DelimSet &set) {
+			__m256i delims[_DelimSet::maxSIMD];
+			for (size_t i = 0; i < set.count; ++i) delims[i] = _mm256_set1_epi8(set.chars[i]);
+			for (; end - pos >= 32; pos += 32) {
+				const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pos));
+				__m256i match = _mm256_cmpeq_epi8(v, delims[0]);
+				for (size_t i = 1; i < set.count; ++i) match = _mm256_or_si256(match, _mm256_cmpeq_epi8(v, delims[i]));
+				const unsigned int mask = (unsigned int) _mm256_movemask_epi8(match);
+				if (mask != 0u) return pos + _lowestBit(mask);
+			}
+			return _findAnySSE2(pos, end, set);
+		};
+#endif
+
+		typedef const char* (*_FindAny)(const char*, const char*, const _DelimSet&);
+
+		/// Pick the search for a delimiter set once, when a split is created, so each token costs no dispatch
+		inline _FindAny _findAnyKernel(const _DelimSet &set) {
+			if (set.count == 0u || set.count > _DelimSet::maxSIMD)	return &_findAnyScalar;
+#ifdef STR_EXT_X86
+			if (_cpu().avx2)										return &_findAnyAVX2;
+			if (_cpu().sse2)										return &_findAnySSE2;
+#endif
+			/// memchr is vectorized by the C library when the kernels are not available
+			if (set.count == 1u)									return &_findOneScalar;
+			return &_findAnyScalar;
+		};
+
+		/// ASCII only case conversion, bytes outside A-Z / a-z (including UTF-8) are left as they are
+		inline char _asciiLower(const char c) { return (c >= 'A' && c <= 'Z') ? (char) (c + ('a' - 'A')) : c; };
+		inline char _asciiUpper(const char c) { return (c >= 'a' && c <= 'z') ? (char) (c - ('a' - 'A')) : c; };
+
+		inline void _convertCaseScalar(char *out, const char *in, const size_t n, const bool upper) {
+			if (upper)	for (size_t i = 0; i < n; ++i) out[i] = _asciiUpper(in[i]);
+			else		for (size_t i = 0; i < n; ++i) out[i] = _asciiLower(in[i]);
+		};
+
+		inline bool _iequalsScalar(const char *a, const char *b, const size_t n) {
+			for (size_t i = 0; i < n; ++i) if (_asciiLower(a[i]) != _asciiLower(b[i])) return false;
+			return true;
+		};
+
+#ifdef STR_EXT_X86
+		/// Flip the case bit of the letters in v. Shifting the range to the bottom of the signed bytes finds them with one compare
+		STR_EXT_TARGET("sse2")
+		inline __m128i _convertCaseSSE2(const __m128i v, const bool upper) {
+			const __m128i shifted = _mm_add_epi8(v, _mm_set1_epi8((char) (0x80 - (upper ? 'a' : 'A'))));
+			const __m128i letters = _mm_cmplt_epi8(shifted, _mm_set1_epi8((char) (0x80 + 26)));
+			return _mm_xor_si128(v, _mm_and_si128(letters, _mm_set1_epi8(0x20)));
+		};
+
+		STR_EXT_TARGET("avx2")
+		inline __m256i _convertCaseAVX2(const __m256i v, const bool upper) {
+			const __m256i shifted = _mm256_add_epi8(v, _mm256_set1_epi8((char) (0x80 - (upper ? 'a' : 'A'))));
+			const __m256i letters = _mm256_cmpgt_epi8(_mm256_set1_epi8((char) (0x80 + 26)), shifted);
+			return _mm256_xor_si256(v, _mm256_and_si256(letters, _mm256_set1_epi8(0x20)));
+		};
+
+		/// Case conversion of 16 bytes at a time, in and out may be the same
+		STR_EXT_TARGET("sse2")
+		inline size_t _convertCaseSSE2(char *out, const char *in, const size_t n, const bool upper) {
+			size_t i = 0;
+			for (; i + 16u <= n; i += 16u) {
+				const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _convertCaseSSE2(v, upper));
+			}
+			return i;
+		};
+
+		STR_EXT_TARGET("avx2")
+		inline size_t _convertCaseAVX2(char *out, const char *in, const size_t n, const bool upper) {
+			size_t i = 0;
+			for (; i + 32u <= n; i += 32u) {
+				const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in + i));
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), _convertCaseAVX2(v, upper));
+			}
+			return i + _convertCaseSSE2(out + i, in + i, n - i, upper);
+		};
+
+		/// Lower case both sides and compare 16 bytes at a time, returns the number of bytes found equal or n on a difference
+		STR_EXT_TARGET("sse2")
+		inline size_t _iequalsSSE2(const char *a, const char *b, const size_t n, bool &differ) {
+			size_t i = 0;
+			for (; i + 16u <= n; i += 16u) {
+				const __m128i va = _convertCaseSSE2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)), false);
+				const __m128i vb = _convertCaseSSE2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)), false);
+				if (_mm_movemask_epi8(_mm_cmpeq_epi8(va, vb)) != 0xFFFF) {
+					differ = true;
+					return n;
+				}
+			}
+			return i;
+		};
+
+		STR_EXT_TARGET("avx2")
+		inline size_t _iequalsAVX2(const char *a, const char *b, const size_t n, bool &differ) {
+			size_t i = 0;
+			for (; i + 32u <= n; i += 32u) {
+				const __m256i va = _convertCaseAVX2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i)), false);
+				const __m256i vb = _convertCaseAVX2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(b + i)), false);
+				if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(va, vb)) != -1) {
+					differ = true;
+					return n;
+				}
+			}
+			return i + _iequalsSSE2(a + i, b + i, n - i, differ);
+		};
+#endif
+
+		/// ASCII case conversion of n bytes using the widest kernel the CPU supports, in and out may be the same
+		inline void _convertCase(char *out, const char *in, const size_t n, const bool upper) {
+			size_t done = 0;
+#ifdef STR_EXT_X86
+			if (_cpu().avx2)		done = _convertCaseAVX2(out, in, n, upper);
+			else if (_cpu().sse2)	done = _convertCaseSSE2(out, in, n, upper);
+#endif
+			_convertCaseScalar(out + done, in + done, n - done, upper);
+		};
+
+		/// Compare n bytes ignoring ASCII case using the widest kernel the CPU supports
+		inline bool _iequals(const char *a, const char *b, const size_t n) {
+			size_t done = 0;
+			bool differ = false;
+#ifdef STR_EXT_X86
+			if (_cpu().avx2)		done = _iequalsAVX2(a, b, n, differ);
+			else if (_cpu().sse2)	done = _iequalsSSE2(a, b, n, differ);
+#endif
+			return !differ && _iequalsScalar(a + done, b + done, n - done);
+		};
+
+		/// Mix 8 bytes into a hash, multiply then fold the high half back down
+		inline unsigned long long _hashMix(const unsigned long long h, const unsigned long long word) {
+			const unsigned long long x = (h ^ word) * 0x9E3779B97F4A7C15ull;
+			return x ^ (x >> 29);
+		};
+
+		/**
+		* Hash of the text with ASCII letters lower cased, so strings which only differ in case hash the same.
+		* The text is lower cased a block at a time into a stack buffer by the SIMD kernels, then mixed 8 bytes at a time.
+		*/
+		inline size_t _ihash(const char *s, const size_t n) {
+			unsigned long long h = 0xCBF29CE484222325ull ^ (unsigned long long) n;
+			char block[256];
+			for (size_t done = 0; done < n;) {
+				const size_t count = std::min(n - done, sizeof(block));
+				_convertCase(block, s + done, count, false);
+				/// The last partial word is padded with zeros, the length mixed in up front keeps padding from colliding
+				const size_t padded = (count + 7u) & ~(size_t) 7u;
+				std::memset(block + count, 0, padded - count);
+				for (size_t i = 0; i < padded; i += 8u) {
+					unsigned long long word;
+					std::memcpy(&word, block + i, 8u);
+					h = _hashMix(h, word);
+				}
+				done += count;
+			}
+			h *= 0xFF51AFD7ED558CCDull;
+			return (size_t) (h ^ (h >> 32));
+		};
+
+		/**
+		* Aho-Corasick automaton over a set of patterns, finding leftmost longest matches without overlaps.
+		* Bytes are mapped to classes so the transition table only has a column for each distinct byte in the patterns,
+		* and every failure link is folded into the table so each byte of input costs one lookup.
+		*/
+		class _MultiMatcher {
+		public:
+			/**
+			* @param patterns	The patterns, none may be empty. Where two are the same the first is matched
+			* @param count		The number of patterns
+			*/
+			_MultiMatcher(const std::string *patterns, const size_t count) : _numClasses(1u), _first(nullptr, 0u), _findFirst(nullptr) {
+				/// Class 0 is every byte which starts no transition
+				std::memset(_classes, 0, sizeof(_classes));
+				std::string firstBytes;
+				for (size_t i = 0; i < count; ++i) {
+					_lengths.push_back(patterns[i].size());
+					for (const char c : patterns[i])
+						if (_classes[(unsigned char) c] == 0u) _classes[(unsigned char) c] = (unsigned char) _numClasses++;
+					if (!patterns[i].empty() && firstBytes.find(patterns[i][0]) == std::string::npos) firstBytes += patterns[i][0];
+				}
+				_first = _DelimSet(firstBytes.data(), firstBytes.size());
+				_findFirst = _findAnyKernel(_first);
+
+				/// Build the trie, missing transitions are filled in below
+				const unsigned int none = (unsigned int) -1;
+				_next.assign(_numClasses, none);
+				_depth.assign(1u, 0u);
+				_match.assign(1u, -1);
+				for (size_t i = 0; i < count; ++i) {
+					unsigned int state = 0;
+					for (const char c : patterns[i]) {
+						unsigned int &next = _next[state * _numClasses + _classes[(unsigned char) c]];
+						if (next == none) {
+							next = (unsigned int) _depth.size();
+							_depth.push_back(_depth[state] + 1u);
+							_match.push_back(-1);
+							_next.resize(_next.size() + _numClasses, none);
+						}
+						state = _next[state * _numClasses + _classes[(unsigned char) c]];
+					}
+					if (_match[state] < 0) _match[state] = (int) i;
+				}
+
+				/// Breadth first, each state takes the transitions of its failure state where it has none of its own,
+				/// and the longest pattern ending at a state is its own or else the one ending at its failure state
+				std::vector<unsigned int> fail(_depth.size(), 0u), queue;
+				for (size_t c = 0; c < _numClasses; ++c) {
+					unsigned int &next = _next[c];
+					if (next == none)	next = 0u;
+					else				queue.push_back(next);
+				}
+				for (size_t head = 0; head < queue.size(); ++head) {
+					const unsigned int state = queue[head];
+					if (_match[state] < 0) _match[state] = _match[fail[state]];
+					for (size_t c = 0; c < _numClasses; ++c) {
+						unsigned int &next = _next[state * _numClasses + c];
+						const unsigned int failNext = _next[fail[state] * _numClasses + c];
+						if (next == none) {
+							next = failNext;
+						}
+						else {
+							fail[next] = failNext;
+							queue.push_back(next);
+						}
+					}
+				}
+			};
+
+			/**
+			* Find the leftmost longest matches in order, scanning resumes after each match so they never overlap
+			* @param pos		Start of the text
+			* @param end		End of the text
+			* @param onMatch	Called as onMatch(start, end, pattern) for each match
+			*/
+			template<typename OnMatch>
+			inline void find(const char *pos, const char *const end, OnMatch &&onMatch) const {
+				unsigned int state = 0;
+				const char *matchStart = nullptr, *matchEnd = nullptr;
+				int match = -1;
+				while (true) {
+					if (state == 0u && match < 0) {
+						/// Nothing is in progress, so skip to the next byte which can start a pattern
+						pos = _findFirst(pos, end, _first);
+					}
+					if (pos == end) {
+						if (match < 0) return;
+					}
+					else {
+						state = _next[state * _numClasses + _classes[(unsigned char) *(pos++)]];
+						const int found = _match[state];
+						if (found >= 0) {
+							const char *start = pos - _lengths[(size_t) found];
+							if (match < 0 || start <= matchStart) {
+								match = found;
+								matchStart = start;
+								matchEnd = pos;
+							}
+						}
+						/// A match is final once the automaton can no longer be extending one which starts at or before it
+						if (match < 0 || (size_t) (pos - matchStart) <= _depth[state]) continue;
+					}
+
+					onMatch(matchStart, matchEnd, (size_t) match);
+					pos = matchEnd;
+					state = 0u;
+					match = -1;
+				}
+			};
+
+		private:
+			unsigned char _classes[256];
+			size_t _numClasses;
+			std::vector<unsigned int> _next;	/// States by byte class
+			std::vector<unsigned int> _depth;	/// Length of the prefix each state represents
+			std::vector<int> _match;			/// Longest pattern ending at each state, -1 for none
+			std::vector<size_t> _lengths;
+			_DelimSet _first;					/// First bytes of the patterns
+			_FindAny _findFirst;
+		};
+
+	}; /// imp namespace
+
+	/// Public interface
+	#define format_str(...) str::format(__LINE__, __FILE__, __VA_ARGS__)
+
+	/// Wrap a string literal format to have it parsed and typechecked at compile time, format_str(fmt_lit("..."), args...)
+#ifdef STR_EXT_CPP14
+	#define fmt_lit(s) ([]() { \
+		struct _Lit : str::imp::_Literal { \
+			static constexpr const char* data() { return s; }; \
+			static constexpr size_t size() { return sizeof(s) - 1u; }; \
+		}; \
+		return _Lit(); }())
+#else
+	#define fmt_lit(s) s
+#endif
+
+#ifdef STR_EXT_CPP14
+	/**
+	 * Fixed capacity string returned by str::static_format, always nul terminated.
+	 * A literal type, so a constexpr static_string is built by the compiler and lives in read only data.
+	 */
+	template<size_t N>
+	struct static_string {
+		constexpr static_string() : _chars(), _size(0u) {};
+
+		constexpr const char* data() const { return _chars; };
+		constexpr const char* c_str() const { return _chars; };
+		constexpr size_t size() const { return _size; };
+		constexpr bool empty() const { return _size == 0u; };
+		static constexpr size_t capacity() { return N; };
+		constexpr const char* begin() const { return _chars; };
+		constexpr const char* end() const { return _chars + _size; };
+		constexpr char operator[](const size_t i) const { return _chars[i]; };
+
+		inline std::string str() const { return std::string(_chars, _size); };
+#ifdef STR_EXT_CPP17
+		constexpr operator std::string_view() const { return std::string_view(_chars, _size); };
+#endif
+
+		/// Append n chars, anything past the capacity is dropped
+		constexpr void append(const char *s, const size_t n) {
+			for (size_t i = 0; i < n && _size < N; ++i) _chars[_size++] = s[i];
+		};
+
+		constexpr void append(const size_t n, const char c) {
+			for (size_t i = 0; i < n && _size < N; ++i) _chars[_size++] = c;
+		};
+
+	private:
+		char _chars[N + 1u];
+		size_t _size;
+	};
+
+	template<size_t N>
+	inline std::ostream& operator<<(std::ostream &os, const static_string<N> &s) {
+		return os.write(s.data(), (std::streamsize) s.size());
+	};
+
+	/**
+	 * Formats at compile time when the arguments are constants, the result is sized from the format and argument types
+	 * so never allocates. Supports integers, chars, bools and char arrays with the flags, widths and precisions of
+	 * str::format, '*' widths and precisions are not allowed. Constant evaluation needs C++17 for fmt_lit("...").
+	 * @param fmt		The format string wrapped by fmt_lit("...")
+	 * @param ...args	The set of arguments to insert into fmt
+	 * @return			A static_string holding the output
+	 */
+	template<typename S, typename ...Args>
+	constexpr typename std::enable_if<std::is_base_of<imp::_Literal, S>::value, static_string<imp::_CTStatic<S, Args...>::capacity>>::type
+	static_format(const S &fmt, const Args &...args) {
+		static_string<imp::_CTStatic<S, Args...>::capacity> ret;
+		imp::_ctStaticFormat<S>(ret, std::forward_as_tuple(args...), std::make_index_sequence<imp::_CTFormat<S>::numItems>());
+		return ret;
+	};
+
+#ifdef STR_EXT_CPP20
+	/**
+	 * Formats at compile time with the format string as a template argument, str::static_format<"%08x-%s">(0xBEEF, "key")
+	 * @param ...args	The set of arguments to insert into the format string
+	 * @return			A static_string holding the output
+	 */
+	template<imp::_FixedString F, typename ...Args>
+	constexpr auto static_format(const Args &...args) {
+		return str::static_format(imp::_FixedLiteral<F>(), args...);
+	};
+#endif
+#endif
+
+	/// Output handle given to str::formatter<T>::format
+	typedef imp::_Writer writer;
+
+	/**
+	* How '%s' writes a value of type T. Specialize with a format(str::writer &out, const T &val) method 
+	* writing straight into out, precision and width are applied around it. The default uses ostream<<
+	*/
+	template<typename T, typename Enable>
+	struct formatter {
+		inline void format(writer &out, const T &val) const { out.stream(val); };
+	};
+
+	/// Strings are written as they are without copying
+	template<>
+	struct formatter<std::string> {
+		inline void format(writer &out, const std::string &val) const { out.append(val.data(), val.size()); };
+	};
+
+	template<>
+	struct formatter<const char*> {
+		inline void format(writer &out, const char *val) const { out.append((val != nullptr) ? val : "(null)"); };
+	};
+
+	template<>
+	struct formatter<char*> : formatter<const char*> {};
+
+	template<size_t N>
+	struct formatter<char[N]> {
+		inline void format(writer &out, const char (&val)[N]) const {
+			const void *end = std::memchr(val, '\0', N);
+			out.append(val, (end != nullptr) ? (size_t) (static_cast<const char*>(end) - val) : N);
+		};
+	};
+
+#ifdef STR_EXT_CPP17
+	template<>
+	struct formatter<std::string_view> {
+		inline void format(writer &out, const std::string_view &val) const { out.append(val.data(), val.size()); };
+	};
+#endif
+
+	/// Type erased view of a set of format arguments, create with str::make_format_args(args...)
+	class format_args {
+	public:
+		format_args() : _args(nullptr), _size(0u) {};
+		format_args(const imp::_Arg *args, const size_t size) : _args(args), _size(size) {};
+
+		inline const imp::_Arg* data() const { return _args; };
+		inline size_t size() const { return _size; };
+
+	private:
+		const imp::_Arg *_args;
+		size_t _size;
+	};
+
+	/// Holds type erased references to a set of format arguments, the arguments must outlive it
+	template<typename ...Args>
+	class format_arg_store {
+	public:
+		explicit format_arg_store(Args &&...args) : _args{ imp::_makeArg(std::forward<Args>(args))..., imp::_Arg() } {};
+
+		inline operator format_args() const { return format_args(_args, sizeof...(Args)); };
+
+	private:
+		imp::_Arg _args[sizeof...(Args) + 1u];
+	};
+
+	/**
+	* Capture references to a set of arguments for str::vformat
+	* @param ...args	The set of arguments, which must outlive the returned store
+	* @return			The store of type erased arguments, converts to str::format_args
+	*/
+	template<typename ...Args>
+	inline format_arg_store<Args...> make_format_args(Args &&...args) {
+		return format_arg_store<Args...>(std::forward<Args>(args)...);
+	};
+
+	/**
+	 * Formats a string using a type erased set of arguments, this is not a template so can be kept out of line
+	 * @param _line_	Pass along the debug macro __LINE__ from the call site
+	 * @param _file_	Pass along the debug macro __FILE__ from the call site
+	 * @param fmt		The format string to use
+	 * @param args		The arguments to insert into fmt, from str::make_format_args(args...)
+	 * @return			The string fmt with args formatted and inserted where specified
+	 */
+	inline std::string vformat(const int _line_, const char *_file_, const std::string &fmt, const format_args &args) {
+		return str::imp::_formatToString([&](str::imp::_Buffer &ret) {
+			str::imp::_vformat(_line_, _file_, ret, fmt.data(), fmt.data() + fmt.size(), args.data(), args.size());
+		});
+	};
+
+	/// Literals and char pointers are formatted in place rather than being copied into a std::string
+	inline std::string vformat(const int _line_, const char *_file_, const char *fmt, const format_args &args) {
+		return str::imp::_formatToString([&](str::imp::_Buffer &ret) {
+			str::imp::_vformat(_line_, _file_, ret, fmt, fmt + std::strlen(fmt), args.data(), args.size());
+		});
+	};
+#ifdef STR_EXT_CPP17
+	inline std::string vformat(const int _line_, const char *_file_, const std::string_view fmt, const format_args &args) {
+		return str::imp::_formatToString([&](str::imp::_Buffer &ret) {
+			str::imp::_vformat(_line_, _file_, ret, fmt.data(), fmt.data() + fmt.size(), args.data(), args.size());
+		});
+	};
+#endif
+
+	/**
+	* Formats a string using a type erased set of arguments (without call site debug info)
+	* @param fmt		The format string to use
+	* @param args		The arguments to insert into fmt, from str::make_format_args(args...)
+	* @return			The string fmt with args formatted and inserted where specified
+	*/
+	inline std::string vformat(const std::string &fmt, const format_args &args) {
+		return str::vformat(-1, nullptr, fmt, args);
+	};
+
+	/// Formats a string using a type erased set of arguments without copying a literal format (without call site debug info)
+	inline std::string vformat(const char *fmt, const format_args &args) {
+		return str::vformat(-1, nullptr, fmt, args);
+	};
+#ifdef STR_EXT_CPP17
+	inline std::string vformat(const std::string_view fmt, const format_args &args) {
+		return str::vformat(-1, nullptr, fmt, args);
+	};
+#endif
+
+	/**
+	 * Formats a string using the set of provided varadic template arguments
+	 * @param _line_	Pass along the debug macro __LINE__ from the call site
+	 * @param _file_	Pass along the debug macro __FILE__ from the call site
+	 * @param fmt		The format string to use
+	 * @param ...args	The set of arguments to insert into fmt
+	 * @return			The string fmt with args formatted and inserted where specified
+	 */
+	template<typename ...Args>
+	inline std::string format(const int _line_, const char *_file_, const std::string &fmt, Args &&...args) {
+		return str::vformat(_line_, _file_, fmt, str::make_format_args(std::forward<Args>(args)...));
+	};
+
+	/// Literals and char pointers are formatted in place rather than being copied into a std::string
+	template<typename ...Args>
+	inline std::string format(const int _line_, const char *_file_, const char *fmt, Args &&...args) {
+		return str::vformat(_line_, _file_, fmt, str::make_format_args(std::forward<Args>(args)...));
+	};
+#ifdef STR_EXT_CPP17
+	template<typename ...Args>
+	inline std::string format(const int _line_, const char *_file_, const std::string_view fmt, Args &&...args) {
+		return str::vformat(_line_, _file_, fmt, str::make_format_args(std::forward<Args>(args)...));
+	};
+#endif
+
+	/**
+	* Formats a string using the set of provided varadic template arguments (without call site debug info)
+	* @param fmt		The format string to use
+	* @param ...args	The set of arguments to insert into fmt
+	* @return			The string fmt with args formatted and inserted where specified
+	*/
+	template<typename ...Args>
+	inline std::string format(const std::string &fmt, Args &&...args) {
+		return str::format(-1, nullptr, fmt, std::forward<Args>(args)...);
+	};
+
+	/// Formats a string without copying a literal format (without call site debug info)
+	template<typename ...Args>
+	inline std::string format(const char *fmt, Args &&...args) {
+		return str::format(-1, nullptr, fmt, std::forward<Args>(args)...);
+	};
+#ifdef STR_EXT_CPP17
+	template<typename ...Args>
+	inline std::string format(const std::string_view fmt, Args &&...args) {
+		return str::format(-1, nullptr, fmt, std::forward<Args>(args)...);
+	};
+#endif
+
+	/**
+	* A runtime format string which is parsed once up front and can then be used to format many times.
+	* Argument types are typechecked the first time a new set of argument types is bound,
+	* after that only the formatting work is left.
+	*/
+	class compiled_format {
+	public:
+
+		/**
+		* Parse a format string
+		* @param _line_	Pass along the debug macro __LINE__ from the call site
+		* @param _file_	Pass along the debug macro __FILE__ from the call site
+		* @param fmt	The format string to parse
+		*/
+		compiled_format(const int _line_, const char *_file_, const std::string &fmt) 
+			: _line(_line_), _file(_file_), _fmt(fmt), _segments(imp::_parseSegments(_line_, _file_, _fmt)), _checked(nullptr) {};
+
+		/**
+		* Parse a format string (without call site debug info)
+		* @param fmt	The format string to parse
+		*/
+		explicit compiled_format(const std::string &fmt) : compiled_format(-1, nullptr, fmt) {};
+
+		compiled_format(const compiled_format &other) 
+			: _line(other._line), _file(other._file), _fmt(other._fmt), _segments(other._segments), 
+			  _checked(other._checked.load(std::memory_order_relaxed)) {};
+
+		compiled_format& operator=(const compiled_format &other) {
+			_line = other._line;
+			_file = other._file;
+			_fmt = other._fmt;
+			_segments = other._segments;
+			_checked.store(other._checked.load(std::memory_order_relaxed), std::memory_order_relaxed);
+			return *this;
+		};
+
+		/**
+		* Formats a string using the set of provided varadic template arguments
+		* @param ...args	The set of arguments to insert into the format string
+		* @return			The format string with args formatted and inserted where specified
+		*/
+		template<typename ...Args>
+		inline std::string operator()(Args &&...args) const {
+			/// Typecheck only the first time these argument types are seen
+			return vformat(make_format_args(std::forward<Args>(args)...), &imp::_Signature<Args...>::id);
+		};
+
+		/**
+		* Formats a string using a type erased set of arguments
+		* @param args		The arguments to insert into the format string, from str::make_format_args(args...)
+		* @param signature	Identifies the argument types, they are typechecked only if this differs from the last call
+		* @return			The format string with args formatted and inserted where specified
+		*/
+		inline std::string vformat(const format_args &args, const void *signature = nullptr) const {
+			if (signature == nullptr || _checked.load(std::memory_order_relaxed) != signature) {
+				imp::_checkSegments(_line, _file, &(_segments[0]), args.data(), args.size());
+				if (signature != nullptr) _checked.store(signature, std::memory_order_relaxed);
+			}
+
+			return imp::_formatToString([&](imp::_Buffer &ret) {
+				imp::_formatSegments(_line, _file, _fmt.data(), ret, &(_segments[0]), args.data());
+			});
+		};
+
+		/// Same as operator()
+		template<typename ...Args>
+		inline std::string format(Args &&...args) const {
+			return (*this)(std::forward<Args>(args)...);
+		};
+
+		/// The format string
+		inline const std::string& str() const { return _fmt; };
+
+	private:
+		int _line;
+		const char *_file;
+		std::string _fmt;
+		std::vector<imp::_Segment> _segments;
+		mutable std::atomic<const void*> _checked;
+	};
+
+#ifdef STR_EXT_CPP14
+	/**
+	 * Formats a string using a format string which was parsed and typechecked at compile time
+	 * @param _line_	Pass along the debug macro __LINE__ from the call site
+	 * @param _file_	Pass along the debug macro __FILE__ from the call site
+	 * @param fmt		The format string to use, wrapped by fmt_lit("...")
+	 * @param ...args	The set of arguments to insert into fmt
+	 * @return			The string fmt with args formatted and inserted where specified
+	 */
+	template<typename S, typename ...Args>
+	inline typename std::enable_if<std::is_base_of<imp::_Literal, S>::value, std::string>::type
+	format(const int _line_, const char *_file_, const S &fmt, Args &&...args) {
+		return str::imp::_formatToString([&](str::imp::_Buffer &ret) {
+			str::imp::_formatTo(_line_, _file_, ret, fmt, std::forward<Args>(args)...);
+		});
+	};
+
+	/**
+	* Formats a string using a format string which was parsed and typechecked at compile time (without call site debug info)
+	* @param fmt		The format string to use, wrapped by fmt_lit("...")
+	* @param ...args	The set of arguments to insert into fmt
+	* @return			The string fmt with args formatted and inserted where specified
+	*/
+	template<typename S, typename ...Args>
+	inline typename std::enable_if<std::is_base_of<imp::_Literal, S>::value, std::string>::type
+	format(const S &fmt, Args &&...args) {
+		return str::format(-1, nullptr, fmt, std::forward<Args>(args)...);
+	};
+#endif
+
+	/**
+	 * Formats into an output iterator without building an intermediate std::string
+	 * @param _line_	Pass along the debug macro __LINE__ from the call site
+	 * @param _file_	Pass along the debug macro __FILE__ from the call site
+	 * @param out		The output iterator to write to, a char* is written to directly
+	 * @param fmt		The format string to use, either a string or wrapped by fmt_lit("...")
+	 * @param ...args	The set of arguments to insert into fmt
+	 * @return			The iterator past the last char written
+	 */
+	template<typename OutputIt, typename Fmt, typename ...Args>
+	inline OutputIt format_to(const int _line_, const char *_file_, OutputIt out, const Fmt &fmt, Args &&...args) {
+		str::imp::_IteratorBuffer<OutputIt> ret(out);
+		str::imp::_formatTo(_line_, _file_, ret, fmt, std::forward<Args>(args)...);
+		return ret.out();
+	};
+
+	/**
+	* Formats into an output iterator without building an intermediate std::string (without call site debug info)
+	* @param out		The output iterator to write to, a char* is written to directly
+	* @param fmt		The format string to use, either a string or wrapped by fmt_lit("...")
+	* @param ...args	The set of arguments to insert into fmt
+	* @return			The iterator past the last char written
+	*/
+	template<typename OutputIt, typename Fmt, typename ...Args>
+	inline typename std::enable_if<!std::is_integral<OutputIt>::value, OutputIt>::type
+	format_to(OutputIt out, const Fmt &fmt, Args &&...args) {
+		return str::format_to(-1, nullptr, out, fmt, std::forward<Args>(args)...);
+	};
+
+	/// Result of format_to_n, the iterator past the last char written and the size the untruncated output would have been
+	template<typename OutputIt>
+	struct format_to_n_result {
+		OutputIt out;
+		size_t size;
+	};
+
+	/**
+	 * Formats into an output iterator writing at most n chars, the rest of the output is counted but not written
+	 * @param _line_	Pass along the debug macro __LINE__ from the call site
+	 * @param _file_	Pass along the debug macro __FILE__ from the call site
+	 * @param out		The output iterator to write to, a char* is written to directly
+	 * @param n			The maximum number of chars to write
+	 * @param fmt		The format string to use, either a string or wrapped by fmt_lit("...")
+	 * @param ...args	The set of arguments to insert into fmt
+	 * @return			The iterator past the last char written and the size of the untruncated output
+	 */
+	template<typename OutputIt, typename Fmt, typename ...Args>
+	inline format_to_n_result<OutputIt> format_to_n(const int _line_, const char *_file_, OutputIt out, const size_t n, const Fmt &fmt, Args &&...args) {
+		str::imp::_TruncatingBuffer<OutputIt> ret(out, n);
+		str::imp::_formatTo(_line_, _file_, ret, fmt, std::forward<Args>(args)...);
+		format_to_n_result<OutputIt> result = { ret.out(), ret.written() };
+		return result;
+	};
+
+	/**
+	* Formats into an output iterator writing at most n chars (without call site debug info)
+	* @param out		The output iterator to write to, a char* is written to directly
+	* @param n			The maximum number of chars to write
+	* @param fmt		The format string to use, either a string or wrapped by fmt_lit("...")
+	* @param ...args	The set of arguments to insert into fmt
+	* @return			The iterator past the last char written and the size of the untruncated output
+	*/
+	template<typename OutputIt, typename Fmt, typename ...Args>
+	inline typename std::enable_if<!std::is_integral<OutputIt>::value, format_to_n_result<OutputIt>>::type
+	format_to_n(OutputIt out, const size_t n, const Fmt &fmt, Args &&...args) {
+		return str::format_to_n(-1, nullptr, out, n, fmt, std::forward<Args>(args)...);
+	};
+
+	/// Result of format_to_array, the terminating null written after the output and whether the output was cut short
+	struct format_to_array_result {
+		char *out;			/// The terminating null, one past the last char written
+		size_t size;		/// The size the untruncated output would have been, not counting the null
+		bool truncated;
+	};
+
+	/**
+	 * Formats into a fixed size char buffer without allocating, for signal handlers and real time threads. At most size - 1
+	 * chars are written followed by a null, output which does not fit is reported as truncated rather than being an error.
+	 * No heap allocation is made for built in types, apart from floating point values formatted to hundreds of digits.
+	 * @param _line_	Pass along the debug macro __LINE__ from the call site
+	 * @param _file_	Pass along the debug macro __FILE__ from the call site
+	 * @param buf		The buffer to write to
+	 * @param size		The size of buf including room for the null, nothing is written when it is 0
+	 * @param fmt		The format string to use, a char*, string, string_view or wrapped by fmt_lit("...")
+	 * @param ...args	The set of arguments to insert into fmt
+	 * @return			The position of the null, the size of the untruncated output and whether it was truncated
+	 */
+	template<typename Fmt, typename ...Args>
+	inline format_to_array_result format_to_array(const int _line_, const char *_file_, char *buf, const size_t size, const Fmt &fmt, Args &&...args) {
+		if (size == 0u) {
+			str::imp::_CountingBuffer ret;
+			str::imp::_formatTo(_line_, _file_, ret, fmt, std::forward<Args>(args)...);
+			format_to_array_result result = { buf, ret.written(), true };
+			return result;
+		}
+		str::imp::_TruncatingBuffer<char*> ret(buf, size - 1u);
+		str::imp::_formatTo(_line_, _file_, ret, fmt, std::forward<Args>(args)...);
+		format_to_array_result result = { ret.out(), ret.written(), ret.written() >= size };
+		*result.out = '\0';
+		return result;
+	};
+
+	/// Formats into a char array, see format_to_array(_line_, _file_, buf, size, fmt, args...)
+	template<size_t N, typename Fmt, typename ...Args>
+	inline typename std::enable_if<!std::is_integral<Fmt>::value, format_to_array_result>::type
+	format_to_array(const int _line_, const char *_file_, char (&buf)[N], const Fmt &fmt, Args &&...args) {
+		return str::format_to_array(_line_, _file_, buf, N, fmt, std::forward<Args>(args)...);
+	};
+
+	/**
+	* Formats into a fixed size char buffer without allocating (without call site debug info)
+	* @param buf		The buffer to write to
+	* @param size		The size of buf including room for the null, nothing is written when it is 0
+	* @param fmt		The format string to use, a char*, string, string_view or wrapped by fmt_lit("...")
+	* @param ...args	The set of arguments to insert into fmt
+	* @return			The position of the null, the size of the untruncated output and whether it was truncated
+	*/
+	template<typename Fmt, typename ...Args>
+	inline format_to_array_result format_to_array(char *buf, const size_t size, const Fmt &fmt, Args &&...args) {
+		return str::format_to_array(-1, nullptr, buf, size, fmt, std::forward<Args>(args)...);
+	};
+
+	/// Formats into a char array (without call site debug info)
+	template<size_t N, typename Fmt, typename ...Args>
+	inline typename std::enable_if<!std::is_integral<Fmt>::value, format_to_array_result>::type
+	format_to_array(char (&buf)[N], const Fmt &fmt, Args &&...args) {
+		return str::format_to_array(-1, nullptr, buf, N, fmt, std::forward<Args>(args)...);
+	};
+
+	/**
+	 * Count the chars formatting would produce without writing them anywhere
+	 * @param _line_	Pass along the debug macro __LINE__ from the call site
+	 * @param _file_	Pass along the debug macro __FILE__ from the call site
+	 * @param fmt		The format string to use, either a string or wrapped by fmt_lit("...")
+	 * @param ...args	The set of arguments to insert into fmt
+	 * @return			The size of the formatted output
+	 */
+	template<typename Fmt, typename ...Args>
+	inline size_t formatted_size(const int _line_, const char *_file_, const Fmt &fmt, Args &&...args) {
+		str::imp::_CountingBuffer ret;
+		str::imp::_formatTo(_line_, _file_, ret, fmt, std::forward<Args>(args)...);
+		return ret.written();
+	};
+
+	/**
+	* Count the chars formatting would produce without writing them anywhere (without call site debug info)
+	* @param fmt		The format string to use, either a string or wrapped by fmt_lit("...")
+	* @param ...args	The set of arguments to insert into fmt
+	* @return			The size of the formatted output
+	*/
+	template<typename Fmt, typename ...Args>
+	inline typename std::enable_if<!std::is_integral<Fmt>::value, size_t>::type
+	formatted_size(const Fmt &fmt, Args &&...args) {
+		return str::formatted_size(-1, nullptr, fmt, std::forward<Args>(args)...);
+	};
+
+	/**
+	 * Formats a table a row at a time from parallel columns, the format is parsed and typechecked once for all rows
+	 * @param _line_	Pass along the debug macro __LINE__ from the call site
+	 * @param _file_	Pass along the debug macro __FILE__ from the call site
+	 * @param fmt		The format string for one row, its arguments are taken from the columns in order
+	 * @param ...cols	The columns, anything with data() and size() such as std::vector, or a plain array
+	 * @return			The rows one after another
+	 */
+	template<typename ...Cols>
+	inline std::string format_rows(const int _line_, const char *_file_, const std::string &fmt, const Cols &...cols) {
+		return str::imp::_formatToString([&](str::imp::_Buffer &ret) {
+			str::imp::_formatRows(_line_, _file_, ret, fmt, cols...);
+		});
+	};
+
+	/**
+	* Formats a table a row at a time from parallel columns (without call site debug info)
+	* @param fmt		The format string for one row, its arguments are taken from the columns in order
+	* @param ...cols	The columns, anything with data() and size() such as std::vector, or a plain array
+	* @return			The rows one after another
+	*/
+	template<typename ...Cols>
+	inline std::string format_rows(const std::string &fmt, const Cols &...cols) {
+		return str::format_rows(-1, nullptr, fmt, cols...);
+	};
+
+	/**
+	 * Formats a table a row at a time from parallel columns into an output iterator, for tables too large to hold as one string
+	 * @param _line_	Pass along the debug macro __LINE__ from the call site
+	 * @param _file_	Pass along the debug macro __FILE__ from the call site
+	 * @param out		The output iterator to write to, a char* is written to directly
+	 * @param fmt		The format string for one row, its arguments are taken from the columns in order
+	 * @param ...cols	The columns, anything with data() and size() such as std::vector, or a plain array
+	 * @return			The iterator past the last char written
+	 */
+	template<typename OutputIt, typename ...Cols>
+	inline OutputIt format_rows_to(const int _line_, const char *_file_, OutputIt out, const std::string &fmt, const Cols &...cols) {
+		str::imp::_IteratorBuffer<OutputIt> ret(out);
+		str::imp::_formatRows(_line_, _file_, ret, fmt, cols...);
+		return ret.out();
+	};
+
+	/**
+	* Formats a table a row at a time from parallel columns into an output iterator (without call site debug info)
+	* @param out		The output iterator to write to, a char* is written to directly
+	* @param fmt		The format string for one row, its arguments are taken from the columns in order
+	* @param ...cols	The columns, anything with data() and size() such as std::vector, or a plain array
+	* @return			The iterator past the last char written
+	*/
+	template<typename OutputIt, typename ...Cols>
+	inline typename std::enable_if<!std::is_integral<OutputIt>::value, OutputIt>::type
+	format_rows_to(OutputIt out, const std::string &fmt, const Cols &...cols) {
+		return str::format_rows_to(-1, nullptr, out, fmt, cols...);
+	};
+
+	/**
+	 * Formats one record per element of a range across all cores, the output is in the same order as the range.
+	 * The format is parsed once and typechecked once against the first record.
+	 * @param _line_	Pass along the debug macro __LINE__ from the call site
+	 * @param _file_	Pass along the debug macro __FILE__ from the call site
+	 * @param fmt		The format string for one record
+	 * @param begin		Random access iterator to the first record
+	 * @param end		Random access iterator past the last record
+	 * @param proj		Returns the arguments for a record as a std::tuple, such as std::tie(rec.a, rec.b), called from several threads at once
+	 * @return			The records one after another
+	 */
+	template<typename It, typename Proj>
+	inline std::string format_parallel(const int _line_, const char *_file_, const std::string &fmt, const It begin, const It end, const Proj &proj) {
+		std::vector<std::string> texts;
+		const size_t threads = std::max(std::thread::hardware_concurrency(), 1u);
+		str::imp::_formatParallel(_line_, _file_, fmt, begin, end, proj, threads, (size_t) -1, [&texts](std::string &text) {
+			texts.push_back(std::move(text));
+		});
+
+		/// Stitch the chunks together with a single allocation
+		size_t size = 0u;
+		for (const std::string &text : texts) size += text.size();
+		std::string ret;
+		ret.reserve(size);
+		for (const std::string &text : texts) ret += text;
+		return ret;
+	};
+
+	/**
+	* Formats one record per element of a range across all cores (without call site debug info)
+	* @param fmt		The format string for one record
+	* @param begin		Random access iterator to the first record
+	* @param end		Random access iterator past the last record
+	* @param proj		Returns the arguments for a record as a std::tuple, such as std::tie(rec.a, rec.b), called from several threads at once
+	* @return			The records one after another
+	*/
+	template<typename It, typename Proj>
+	inline std::string format_parallel(const std::string &fmt, const It begin, const It end, const Proj &proj) {
+		return str::format_parallel(-1, nullptr, fmt, begin, end, proj);
+	};
+
+	/**
+	 * Formats one record per element of a range across all cores, handing the output to a sink in order a chunk at a time.
+	 * Only a few chunks per thread are held at once, so memory stays bounded however large the range.
+	 * @param _line_	Pass along the debug macro __LINE__ from the call site
+	 * @param _file_	Pass along the debug macro __FILE__ from the call site
+	 * @param sink		Called as sink(const char *data, size_t size) on the calling thread, in order
+	 * @param fmt		The format string for one record
+	 * @param begin		Random access iterator to the first record
+	 * @param end		Random access iterator past the last record
+	 * @param proj		Returns the arguments for a record as a std::tuple, such as std::tie(rec.a, rec.b), called from several threads at once
+	 */
+	template<typename Sink, typename It, typename Proj>
+	inline void format_parallel_to(const int _line_, const char *_file_, Sink &&sink, const std::string &fmt, const It begin, const It end, const Proj &proj) {
+		const size_t threads = std::max(std::thread::hardware_concurrency(), 1u);
+		str::imp::_formatParallel(_line_, _file_, fmt, begin, end, proj, threads, 4u * threads, [&sink](std::string &text) {
+			sink(static_cast<const char*>(text.data()), text.size());
+		});
+	};
+
+	/**
+	* Formats one record per element of a range across all cores, handing the output to a sink in order (without call site debug info)
+	* @param sink		Called as sink(const char *data, size_t size) on the calling thread, in order
+	* @param fmt		The format string for one record
+	* @param begin		Random access iterator to the first record
+	* @param end		Random access iterator past the last record
+	* @param proj		Returns the arguments for a record as a std::tuple, such as std::tie(rec.a, rec.b), called from several threads at once
+	*/
+	template<typename Sink, typename It, typename Proj>
+	inline void format_parallel_to(Sink &&sink, const std::string &fmt, const It begin, const It end, const Proj &proj) {
+		str::format_parallel_to(-1, nullptr, std::forward<Sink>(sink), fmt, begin, end, proj);
+	};
+
+	/**
+	 * Formats onto the end of an existing string, reusing its capacity so a string kept between calls stops allocating
+	 * @param _line_	Pass along the debug macro __LINE__ from the call site
+	 * @param _file_	Pass along the debug macro __FILE__ from the call site
+	 * @param dst		The string to append to, %n counts from the end of what it already held
+	 * @param fmt		The format string to use, either a string or wrapped by fmt_lit("...")
+	 * @param ...args	The set of arguments to insert into fmt
+	 * @return			dst
+	 */
+	template<typename Fmt, typename ...Args>
+	inline std::string& format_append(const int _line_, const char *_file_, std::string &dst, const Fmt &fmt, Args &&...args) {
+		str::imp::_StringBuffer ret(dst);
+		str::imp::_formatTo(_line_, _file_, ret, fmt, std::forward<Args>(args)...);
+		ret.flush();
+		return dst;
+	};
+
+	/**
+	* Formats onto the end of an existing string (without call site debug info)
+	* @param dst		The string to append to, %n counts from the end of what it already held
+	* @param fmt		The format string to use, either a string or wrapped by fmt_lit("...")
+	* @param ...args	The set of arguments to insert into fmt
+	* @return			dst
+	*/
+	template<typename Fmt, typename ...Args>
+	inline std::string& format_append(std::string &dst, const Fmt &fmt, Args &&...args) {
+		return str::format_append(-1, nullptr, dst, fmt, std::forward<Args>(args)...);
+	};
+
+	/**
+	 * Concatenates its arguments into a string with a single allocation, every argument is measured before anything is written.
+	 * Strings are copied as they are, integers are written as by '%d' or '%u', floats '%g', chars '%c', bools 'true' / 'false'
+	 * and pointers '%p'. Types written by str::formatter<T> or operator<< are formatted once, to a stack buffer.
+	 * @param ...args	The values to concatenate
+	 * @return			Returns the concatenated string
+	 */
+	template<typename ...Args>
+	inline std::string cat(const Args &...args) {
+		const str::imp::_Arg argArray[] = { str::imp::_makeArg(args)..., str::imp::_Arg() };
+		str::imp::_CatPiece pieces[sizeof...(Args) + 1u];
+		return str::imp::_vcat(argArray, pieces, sizeof...(Args));
+	};
+
+	/**
+	 * Joins the elements of a range with a separator into a string with a single allocation, elements are written as by str::cat
+	 * @param range		Anything with begin() and end() forward iterators, walked twice
+	 * @param sep		The separator, a string or a char
+	 * @return			Returns the joined string
+	 */
+	template<typename Range, typename Sep>
+	inline std::string join(const Range &range, const Sep &sep) {
+		str::imp::_MemoryBuffer<64> scratch;
+		str::imp::_CatPiece sepPiece;
+		str::imp::_catMeasure(sepPiece, str::imp::_makeArg(sep), scratch);
+		return str::imp::_join(std::begin(range), std::end(range), sepPiece.data(scratch), sepPiece.size);
+	};
+
+	/// Joins a braced list, str::join({ a, b, c }, ", ")
+	template<typename T, typename Sep>
+	inline std::string join(const std::initializer_list<T> range, const Sep &sep) {
+		return str::join<std::initializer_list<T>, Sep>(range, sep);
+	};
+
+	/**
+	 * A set of substitutions compiled once into an Aho-Corasick automaton, reusable across any number of inputs.
+	 * Replacing finds the leftmost longest match at each point in one pass over the input, so the cost does not grow
+	 * with the number of patterns, and replaced text is never matched again.
+	 */
+	class replacer {
+	public:
+		typedef std::pair<std::string, std::string> pair_type;
+
+		/// Compile a braced list of { from, to } pairs, str::replacer({ { "{name}", name }, { "{id}", id } })
+		replacer(const std::initializer_list<pair_type> pairs) : replacer(pairs.begin(), pairs.end()) {};
+
+		/**
+		 * Compile a range of pairs whose first is the text to find and second its replacement
+		 * @param begin		Iterator to the first pair
+		 * @param end		Iterator past the last pair
+		 */
+		template<typename It>
+		replacer(const It begin, const It end) : _matcher(_compile(begin, end)) {};
+
+		/**
+		 * Replace every match, the output is allocated once. When no replacement is longer than its pattern the output is
+		 * written in the same pass that finds the matches, otherwise the matches are found once more to measure it first.
+		 * @param text		The text to replace in, a char*, string or string_view
+		 * @return			Returns the text with the replacements made
+		 */
+		inline std::string operator()(const str::imp::_TextRef text) const {
+			const char *begin = text.data, *end = text.data + text.size;
+			size_t size = text.size;
+			if (!_shrinks) {
+				_matcher->find(begin, end, [this, &size](const char *start, const char *stop, const size_t i) {
+					size = size - (size_t) (stop - start) + _to[i].size();
+				});
+			}
+
+			std::string ret;
+			if (size == 0u) return ret;
+			ret.resize(size);
+			char *out = &(ret[0]);
+			const char *last = begin;
+			_matcher->find(begin, end, [this, &out, &last](const char *start, const char *stop, const size_t i) {
+				std::memcpy(out, last, (size_t) (start - last));
+				out += start - last;
+				std::memcpy(out, _to[i].data(), _to[i].size());
+				out += _to[i].size();
+				last = stop;
+			});
+			std::memcpy(out, last, (size_t) (end - last));
+			out += end - last;
+			if (_shrinks) ret.resize((size_t) (out - ret.data()));
+			return ret;
+		};
+
+		/// Number of patterns
+		inline size_t size() const { return _to.size(); };
+
+	private:
+		template<typename It>
+		inline std::shared_ptr<const str::imp::_MultiMatcher> _compile(const It begin, const It end) {
+			std::vector<std::string> from;
+			_shrinks = true;
+			for (It it = begin; it != end; ++it) {
+				if (it->first.empty()) {
+					std::cerr << "String Format | Replacement pattern can not be empty: Replacing with '" << it->second << '\'' << std::endl << std::endl;
+					std::exit(EXIT_FAILURE);
+				}
+				from.push_back(it->first);
+				_to.push_back(it->second);
+				_shrinks = _shrinks && (_to.back().size() <= from.back().size());
+			}
+			return std::make_shared<const str::imp::_MultiMatcher>(from.data(), from.size());
+		};
+
+		std::vector<std::string> _to;
+		bool _shrinks;			/// No replacement is longer than its pattern, so the output is never longer than the input
+		std::shared_ptr<const str::imp::_MultiMatcher> _matcher;
+	};
+
+	/**
+	 * Replace every match of a set of patterns, see str::replacer to compile them once for many inputs
+	 * @param text		The text to replace in, a char*, string or string_view
+	 * @param pairs		{ from, to } pairs, the leftmost longest match wins at each point and replaced text is not matched again
+	 * @return			Returns the text with the replacements made
+	 */
+	inline std::string replace_all(const str::imp::_TextRef text, const std::initializer_list<replacer::pair_type> pairs) {
+		return replacer(pairs)(text);
+	};
+
+	/// Replace every match of a compiled set of patterns
+	inline std::string replace_all(const str::imp::_TextRef text, const replacer &patterns) {
+		return patterns(text);
+	};
+
+	/**
+	 * Lower case the ASCII letters of a string, 16 or 32 bytes at a time with SSE2 or AVX2. Other bytes, including UTF-8, are left as they are
+	 * @param text		A char*, string or string_view
+	 * @return			Returns the lower cased copy
+	 */
+	inline std::string to_lower(const str::imp::_TextRef text) {
+		std::string ret(text.size, '\0');
+		if (text.size != 0u) str::imp::_convertCase(&(ret[0]), text.data, text.size, false);
+		return ret;
+	};
+
+	/// Upper case the ASCII letters of a string, see str::to_lower
+	inline std::string to_upper(const str::imp::_TextRef text) {
+		std::string ret(text.size, '\0');
+		if (text.size != 0u) str::imp::_convertCase(&(ret[0]), text.data, text.size, true);
+		return ret;
+	};
+
+	/// Lower case the ASCII letters of a string where it is
+	inline void to_lower_in_place(char *data, const size_t size) { str::imp::_convertCase(data, data, size, false); };
+	inline void to_lower_in_place(std::string &text) { if (!text.empty()) to_lower_in_place(&(text[0]), text.size()); };
+
+	/// Upper case the ASCII letters of a string where it is
+	inline void to_upper_in_place(char *data, const size_t size) { str::imp::_convertCase(data, data, size, true); };
+	inline void to_upper_in_place(std::string &text) { if (!text.empty()) to_upper_in_place(&(text[0]), text.size()); };
+
+	/// Whether two strings are equal ignoring ASCII case
+	inline bool iequals(const str::imp::_TextRef a, const str::imp::_TextRef b) {
+		return a.size == b.size && str::imp::_iequals(a.data, b.data, a.size);
+	};
+
+	/// Whether a string starts with a prefix ignoring ASCII case
+	inline bool istarts_with(const str::imp::_TextRef text, const str::imp::_TextRef prefix) {
+		return text.size >= prefix.size && str::imp::_iequals(text.data, prefix.data, prefix.size);
+	};
+
+	/**
+	 * Hash ignoring ASCII case, for unordered containers keyed by case insensitive strings together with str::iequal_to
+	 *
+	 *	std::unordered_map<std::string, T, str::ihash, str::iequal_to> headers;
+	 */
+	struct ihash {
+		/// Lets C++20 containers look up a string_view or char* without making a std::string
+		typedef void is_transparent;
+
+		inline size_t operator()(const str::imp::_TextRef text) const { return str::imp::_ihash(text.data, text.size); };
+	};
+
+	/// Equality ignoring ASCII case, see str::ihash
+	struct iequal_to {
+		typedef void is_transparent;
+
+		inline bool operator()(const str::imp::_TextRef a, const str::imp::_TextRef b) const { return str::iequals(a, b); };
+	};
+
+	/// Print straight to a destination, print_str(dest, "...", args...)
+	#define print_str(dest, ...) str::print(__LINE__, __FILE__, dest, __VA_ARGS__)
+
+	/**
+	 * Formats straight to a stream, through a small stack buffer rather than a temporary string
+	 * @param _line_	Pass along the debug macro __LINE__ from the call site
+	 * @param _file_	Pass along the debug macro __FILE__ from the call site
+	 * @param os		The stream to write to, badbit is set if the write fails
+	 * @param fmt		The format string to use, a char*, string, string_view or wrapped by fmt_lit("...")
 	 * @param ...args	The set of arguments to insert into fmt
-	 * @return			The string fmt with args formatted and inserted where specified
+	 * @return			Returns true if all of the output was written
 	 */
-	template<typename ...Args>
-	inline std::string format(const int _line_, const char *_file_, const std::string &fmt, Args &&...args) {
-		std::ostringstream ret;
-		str::imp::_format(_line_, _file_, ret, (char*) &(fmt[0]), (char*) &(fmt[fmt.size()]), std::forward<Args>(args)...);
-		return ret.str();
+	template<typename Fmt, typename ...Args>
+	inline bool print(const int _line_, const char *_file_, std::ostream &os, const Fmt &fmt, Args &&...args) {
+		const std::ostream::sentry sentry(os);
+		if (!sentry) return false;
+		str::imp::_StreamSinkBuffer ret(*os.rdbuf());
+		str::imp::_formatTo(_line_, _file_, ret, fmt, std::forward<Args>(args)...);
+		if (ret.flush()) return true;
+		os.setstate(std::ios_base::badbit);
+		return false;
 	};
 
 	/**
-	* Formats a string using the set of provided varadic template arguments (without call site debug info)
-	* @param fmt		The format string to use
+	* Formats straight to a stream (without call site debug info)
+	* @param os			The stream to write to, badbit is set if the write fails
+	* @param fmt		The format string to use, a char*, string, string_view or wrapped by fmt_lit("...")
 	* @param ...args	The set of arguments to insert into fmt
-	* @return			The string fmt with args formatted and inserted where specified
+	* @return			Returns true if all of the output was written
+	*/
+	template<typename Fmt, typename ...Args>
+	inline bool print(std::ostream &os, const Fmt &fmt, Args &&...args) {
+		return str::print(-1, nullptr, os, fmt, std::forward<Args>(args)...);
+	};
+
+	/**
+	 * Formats straight to a C stdio file, holding its lock so the output is not interleaved with other threads
+	 * @param _line_	Pass along the debug macro __LINE__ from the call site
+	 * @param _file_	Pass along the debug macro __FILE__ from the call site
+	 * @param file		The file to write to
+	 * @param fmt		The format string to use, a char*, string, string_view or wrapped by fmt_lit("...")
+	 * @param ...args	The set of arguments to insert into fmt
+	 * @return			Returns true if all of the output was written
+	 */
+	template<typename Fmt, typename ...Args>
+	inline bool print(const int _line_, const char *_file_, FILE *file, const Fmt &fmt, Args &&...args) {
+#ifdef STR_EXT_POSIX
+		flockfile(file);
+#endif
+		str::imp::_FileSinkBuffer ret(file);
+		str::imp::_formatTo(_line_, _file_, ret, fmt, std::forward<Args>(args)...);
+		const bool ok = ret.flush();
+#ifdef STR_EXT_POSIX
+		funlockfile(file);
+#endif
+		return ok;
+	};
+
+	/**
+	* Formats straight to a C stdio file (without call site debug info)
+	* @param file		The file to write to
+	* @param fmt		The format string to use, a char*, string, string_view or wrapped by fmt_lit("...")
+	* @param ...args	The set of arguments to insert into fmt
+	* @return			Returns true if all of the output was written
 	*/
+	template<typename Fmt, typename ...Args>
+	inline bool print(FILE *file, const Fmt &fmt, Args &&...args) {
+		return str::print(-1, nullptr, file, fmt, std::forward<Args>(args)...);
+	};
+
+#ifdef STR_EXT_POSIX
+	/// A file descriptor to print to, str::print(str::fd(2), "...", args...). Wrapped so it can not be taken for the __LINE__ of a debug overload
+	struct fd {
+		explicit fd(const int handle) : handle(handle) {};
+		int handle;
+	};
+
+	/**
+	 * Formats straight to a file descriptor through a stack buffer, output up to 4096 chars goes out in a single write
+	 * @param _line_	Pass along the debug macro __LINE__ from the call site
+	 * @param _file_	Pass along the debug macro __FILE__ from the call site
+	 * @param out		The file descriptor to write to
+	 * @param fmt		The format string to use, a char*, string, string_view or wrapped by fmt_lit("...")
+	 * @param ...args	The set of arguments to insert into fmt
+	 * @return			Returns true if all of the output was written, otherwise errno is left set by the failed write
+	 */
+	template<typename Fmt, typename ...Args>
+	inline bool print(const int _line_, const char *_file_, const fd out, const Fmt &fmt, Args &&...args) {
+		str::imp::_FdSinkBuffer ret(out.handle);
+		str::imp::_formatTo(_line_, _file_, ret, fmt, std::forward<Args>(args)...);
+		return ret.flush();
+	};
+
+	/**
+	* Formats straight to a file descriptor (without call site debug info)
+	* @param out		The file descriptor to write to
+	* @param fmt		The format string to use, a char*, string, string_view or wrapped by fmt_lit("...")
+	* @param ...args	The set of arguments to insert into fmt
+	* @return			Returns true if all of the output was written, otherwise errno is left set by the failed write
+	*/
+	template<typename Fmt, typename ...Args>
+	inline bool print(const fd out, const Fmt &fmt, Args &&...args) {
+		return str::print(-1, nullptr, out, fmt, std::forward<Args>(args)...);
+	};
+#endif
+
+	/// Read values out of a string, scan_str(input, "...", args...)
+	#define scan_str(input, ...) str::scan(__LINE__, __FILE__, input, __VA_ARGS__)
+
+	/**
+	 * Reads values out of a string, the reverse of str::format. Declarations use the same grammar and typechecking,
+	 * widths limit how many chars a field may take, whitespace in fmt matches any amount of whitespace and all
+	 * other chars must match exactly. Numbers, text and bools skip leading whitespace, '%c' reads exactly one char.
+	 * '%s' reads up to whitespace or the char following it in fmt, a std::string_view argument points into the input.
+	 * Errors in the format string or arguments exit like str::format, only errors in the input are returned.
+	 * @param _line_	Pass along the debug macro __LINE__ from the call site
+	 * @param _file_	Pass along the debug macro __FILE__ from the call site
+	 * @param input		The text to read, a char*, string or string_view, which may be longer than fmt matches
+	 * @param fmt		The format string to match, a char*, string or string_view
+	 * @param ...args	The variables to assign, left untouched from the first one which fails
+	 * @return			Returns how many arguments were assigned, how much input was consumed and why scanning stopped
+	 */
 	template<typename ...Args>
-	inline std::string format(const std::string &fmt, Args &&...args) {
-		return str::format(-1, nullptr, fmt, std::forward<Args>(args)...);
+	inline scan_result scan(const int _line_, const char *_file_, const str::imp::_TextRef input, const str::imp::_TextRef fmt, Args &...args) {
+		return str::imp::_scan(_line_, _file_, input.data, input.size, fmt.data, fmt.size, args...);
+	};
+
+	/**
+	* Reads values out of a string (without call site debug info)
+	* @param input		The text to read, a char*, string or string_view, which may be longer than fmt matches
+	* @param fmt		The format string to match, a char*, string or string_view
+	* @param ...args	The variables to assign, left untouched from the first one which fails
+	* @return			Returns how many arguments were assigned, how much input was consumed and why scanning stopped
+	*/
+	template<typename ...Args>
+	inline scan_result scan(const str::imp::_TextRef input, const str::imp::_TextRef fmt, Args &...args) {
+		return str::imp::_scan(-1, nullptr, input.data, input.size, fmt.data, fmt.size, args...);
+	};
+
+#ifdef STR_EXT_POSIX
+	/// Scatter-gather formatting into a str::iovec_message, iovec_str(msg, "...", args...)
+	#define iovec_str(msg, ...) (msg).format(__LINE__, __FILE__, __VA_ARGS__)
+
+	/**
+	 * Formatted output as a list of iovecs for writev or sendmsg, without concatenating it. Literal segments of
+	 * 64 chars or more point straight into the format string, everything else goes to a side buffer owned by the
+	 * message. The format string must outlive the iovecs, and they are invalidated by the next call to format.
+	 * A message kept between calls reuses its storage so stops allocating.
+	 */
+	class iovec_message {
+	public:
+		iovec_message() : _sideCapacity(0u) {};
+
+		/**
+		 * Replace the contents of the message
+		 * @param _line_	Pass along the debug macro __LINE__ from the call site
+		 * @param _file_	Pass along the debug macro __FILE__ from the call site
+		 * @param fmt		The format string to use, referenced by the iovecs so it must stay alive
+		 * @param ...args	The set of arguments to insert into fmt
+		 * @return			*this
+		 */
+		template<typename ...Args>
+		inline iovec_message& format(const int _line_, const char *_file_, const char *fmt, Args &&...args) {
+			return _format(_line_, _file_, fmt, std::strlen(fmt), std::forward<Args>(args)...);
+		};
+
+		template<typename ...Args>
+		inline iovec_message& format(const int _line_, const char *_file_, const std::string &fmt, Args &&...args) {
+			return _format(_line_, _file_, fmt.data(), fmt.size(), std::forward<Args>(args)...);
+		};
+
+		/// A temporary format string would be gone before the iovecs are used
+		template<typename ...Args>
+		iovec_message& format(const int _line_, const char *_file_, std::string &&fmt, Args &&...args) = delete;
+#ifdef STR_EXT_CPP17
+		template<typename ...Args>
+		inline iovec_message& format(const int _line_, const char *_file_, const std::string_view fmt, Args &&...args) {
+			return _format(_line_, _file_, fmt.data(), fmt.size(), std::forward<Args>(args)...);
+		};
+#endif
+
+		/// Replace the contents of the message (without call site debug info)
+		template<typename ...Args>
+		inline iovec_message& format(const char *fmt, Args &&...args) {
+			return format(-1, nullptr, fmt, std::forward<Args>(args)...);
+		};
+
+		template<typename ...Args>
+		inline iovec_message& format(const std::string &fmt, Args &&...args) {
+			return format(-1, nullptr, fmt, std::forward<Args>(args)...);
+		};
+
+		template<typename ...Args>
+		iovec_message& format(std::string &&fmt, Args &&...args) = delete;
+#ifdef STR_EXT_CPP17
+		template<typename ...Args>
+		inline iovec_message& format(const std::string_view fmt, Args &&...args) {
+			return format(-1, nullptr, fmt, std::forward<Args>(args)...);
+		};
+#endif
+
+		/// The iovecs to pass to writev, there are no empty entries
+		inline const struct iovec* data() const { return _iov.data(); };
+		inline size_t size() const { return _iov.size(); };
+
+		/// Total number of chars across all of the iovecs
+		inline size_t length() const {
+			size_t length = 0u;
+			for (const struct iovec &iov : _iov) length += iov.iov_len;
+			return length;
+		};
+
+		/// The output concatenated into a string
+		inline std::string str() const {
+			std::string ret;
+			ret.reserve(length());
+			for (const struct iovec &iov : _iov) ret.append(static_cast<const char*>(iov.iov_base), iov.iov_len);
+			return ret;
+		};
+
+	private:
+		template<typename ...Args>
+		inline iovec_message& _format(const int _line_, const char *_file_, const char *fmt, const size_t fmtSize, Args &&...args) {
+			const imp::_Arg argArray[] = { imp::_makeArg(std::forward<Args>(args))..., imp::_Arg() };
+			imp::_IovecBuffer ret(_side, _sideCapacity, _pieces);
+			imp::_vformatWith(_line_, _file_, ret, fmt, fmt + fmtSize, argArray, sizeof...(Args));
+			ret.finish(_iov);
+			return *this;
+		};
+
+		std::unique_ptr<char[]> _side;
+		size_t _sideCapacity;
+		std::vector<imp::_IovecPiece> _pieces;
+		std::vector<struct iovec> _iov;
+	};
+
+	/// Formatting into a str::mapped_file, mapped_str(out, "...", args...)
+	#define mapped_str(out, ...) (out).format(__LINE__, __FILE__, __VA_ARGS__)
+
+	/**
+	 * A file written by formatting straight into memory mapped over its end, for multi-GB outputs built a line at a time.
+	 * Output lands in the page cache with no intermediate strings or write calls. The file grows by ftruncate a step at
+	 * a time and is trimmed to the chars written when closed. If it can not grow, later output is dropped and format
+	 * and close return false.
+	 */
+	class mapped_file {
+	public:
+		/**
+		 * Create or truncate a file
+		 * @param path		The file to write
+		 * @param step		Chars to map and grow the file by at a time, rounded up to whole pages
+		 */
+		explicit mapped_file(const std::string &path, const size_t step = 64u << 20) : _ret(path.c_str(), step) {};
+
+		/// Trims and closes the file
+		~mapped_file() {};
+
+		/**
+		 * Formats onto the end of the file
+		 * @param _line_	Pass along the debug macro __LINE__ from the call site
+		 * @param _file_	Pass along the debug macro __FILE__ from the call site
+		 * @param fmt		The format string to use, a char*, string, string_view or wrapped by fmt_lit("...")
+		 * @param ...args	The set of arguments to insert into fmt
+		 * @return			Returns false if the file is not open or could not be grown
+		 */
+		template<typename Fmt, typename ...Args>
+		inline bool format(const int _line_, const char *_file_, const Fmt &fmt, Args &&...args) {
+			imp::_formatTo(_line_, _file_, _ret, fmt, std::forward<Args>(args)...);
+			return _ret.ok();
+		};
+
+		/// Formats onto the end of the file (without call site debug info)
+		template<typename Fmt, typename ...Args>
+		inline typename std::enable_if<!std::is_integral<Fmt>::value, bool>::type format(const Fmt &fmt, Args &&...args) {
+			return format(-1, nullptr, fmt, std::forward<Args>(args)...);
+		};
+
+		/// Chars written so far
+		inline size_t size() const { return _ret.written(); };
+
+		/// False if the file could not be opened or has been closed, or output has been dropped because it could not be grown
+		inline bool ok() const { return _ret.ok(); };
+
+		/**
+		 * Unmaps, trims and closes the file, nothing more can be written afterwards
+		 * @return			Returns true if all of the output was written
+		 */
+		inline bool close() { return _ret.close(); };
+
+	private:
+		mapped_file(const mapped_file&);
+		mapped_file& operator=(const mapped_file&);
+
+		imp::_MappedBuffer _ret;
+	};
+#endif
+
+	/// Deferred formatting through a str::deferred_formatter, deferred_str(log, "...", args...)
+	#define deferred_str(log, ...) (log).format(__LINE__, __FILE__, __VA_ARGS__)
+
+	/**
+	 * Formats on a background thread. Calling threads only copy the arguments into a per-thread ring buffer,
+	 * the background thread formats them later and hands the output to a sink in batches.
+	 *
+	 * Arguments are captured by value. Strings are copied, and types written through str::formatter<T> are
+	 * formatted on the calling thread when captured. A char* is always captured as a string so '%p' needs a void*,
+	 * other pointers given to '%.*h' are only read when formatted so must stay valid until flush(), and '%n' writes
+	 * to the captured copy so has no effect. Output from each thread stays in order, output from different threads
+	 * may be interleaved in any order.
+	 */
+	class deferred_formatter {
+	public:
+		/// Receives formatted output, called from the background thread, or from the calling thread for a call too large
+		/// for its ring. Calls are never concurrent
+		typedef std::function<void(const char *data, size_t size)> sink_type;
+
+		/**
+		 * Starts the background thread
+		 * @param sink		Receives the formatted output
+		 * @param ringSize	Bytes of ring buffer for each calling thread, calls needing more than half of this are formatted synchronously
+		 */
+		explicit deferred_formatter(sink_type sink, const size_t ringSize = 65536u) :
+			_sink(std::move(sink)), _ringSize(_roundRing(ringSize)), _id(_nextId()), _version(0u), _stop(false), _sleeping(false) {
+			_thread = std::thread(&deferred_formatter::_run, this);
+		};
+
+		/// Writes out everything still queued then stops the background thread
+		~deferred_formatter() {
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				_stop = true;
+			}
+			_wake.notify_one();
+			_thread.join();
+		};
+
+		/**
+		 * Queue a call for formatting, the format string must be a string literal as only the pointer is kept.
+		 * A const char array which is not a literal has to outlive the flush and is taken as all N - 1 chars.
+		 * @param _line_	Pass along the debug macro __LINE__ from the call site
+		 * @param _file_	Pass along the debug macro __FILE__ from the call site
+		 * @param fmt		The format string to use
+		 * @param ...args	The set of arguments to insert into fmt
+		 */
+		template<size_t N, typename ...Args>
+		inline void format(const int _line_, const char *_file_, const char (&fmt)[N], Args &&...args) {
+			imp::_Arg argArray[] = { imp::_makeArg(std::forward<Args>(args))..., imp::_Arg() };
+			_push(_line_, _file_, fmt, N - 1u, false, argArray, sizeof...(Args));
+		};
+
+		/// Queue a call with a format in a writable char array, which may be reused before the flush so it is copied up to its null
+		template<size_t N, typename ...Args>
+		inline void format(const int _line_, const char *_file_, char (&fmt)[N], Args &&...args) {
+			imp::_Arg argArray[] = { imp::_makeArg(std::forward<Args>(args))..., imp::_Arg() };
+			const void *end = std::memchr(fmt, '\0', N);
+			_push(_line_, _file_, fmt, (end != nullptr) ? (size_t) (static_cast<const char*>(end) - fmt) : N, true, argArray, sizeof...(Args));
+		};
+
+		/// Queue a call with a runtime format string, which is copied
+		template<typename ...Args>
+		inline void format(const int _line_, const char *_file_, const std::string &fmt, Args &&...args) {
+			imp::_Arg argArray[] = { imp::_makeArg(std::forward<Args>(args))..., imp::_Arg() };
+			_push(_line_, _file_, fmt.data(), fmt.size(), true, argArray, sizeof...(Args));
+		};
+
+		/// Queue a call (without call site debug info)
+		template<size_t N, typename ...Args>
+		inline void format(const char (&fmt)[N], Args &&...args) {
+			format(-1, nullptr, fmt, std::forward<Args>(args)...);
+		};
+
+		template<size_t N, typename ...Args>
+		inline void format(char (&fmt)[N], Args &&...args) {
+			format(-1, nullptr, fmt, std::forward<Args>(args)...);
+		};
+
+		template<typename ...Args>
+		inline void format(const std::string &fmt, Args &&...args) {
+			format(-1, nullptr, fmt, std::forward<Args>(args)...);
+		};
+
+		/// Wait until everything queued so far, by any thread, has been given to the sink
+		inline void flush() {
+			std::vector<std::pair<std::shared_ptr<imp::_DeferredRing>, size_t>> targets;
+			{
+				std::lock_guard<std::mutex> lock(_ringsMutex);
+				for (const std::shared_ptr<imp::_DeferredRing> &ring : _rings)
+					targets.push_back(std::make_pair(ring, ring->_head.load(std::memory_order_acquire)));
+			}
+
+			std::unique_lock<std::mutex> lock(_mutex);
+			_sleeping.store(false, std::memory_order_relaxed);
+			_wake.notify_one();
+			_done.wait(lock, [&targets]() {
+				for (const auto &target : targets)
+					if (target.first->_tail.load(std::memory_order_acquire) - target.second > ((size_t) -1) / 2u) return false;
+				return true;
+			});
+		};
+
+	private:
+		deferred_formatter(const deferred_formatter&);
+		deferred_formatter& operator=(const deferred_formatter&);
+
+		static inline size_t _roundRing(const size_t size) {
+			size_t ring = 1024u;
+			while (ring < size) ring *= 2u;
+			return ring;
+		};
+
+		static inline size_t _nextId() {
+			static std::atomic<size_t> id(0u);
+			return ++id;
+		};
+
+		/// The calling thread's ring, created the first time the thread uses this formatter
+		inline imp::_DeferredRing& _ring() {
+			std::vector<imp::_DeferredSlot> &slots = imp::_deferredSlots();
+			for (const imp::_DeferredSlot &slot : slots)
+				if (slot.id == _id) return *slot.ring;
+
+			/// Drop rings of formatters which have since been destroyed
+			slots.erase(std::remove_if(slots.begin(), slots.end(), [](const imp::_DeferredSlot &slot) {
+				return slot.ring.use_count() == 1;
+			}), slots.end());
+
+			std::shared_ptr<imp::_DeferredRing> ring = std::make_shared<imp::_DeferredRing>(_ringSize);
+			{
+				std::lock_guard<std::mutex> lock(_ringsMutex);
+				_rings.push_back(ring);
+				++_version;
+			}
+			slots.push_back(imp::_DeferredSlot(_id, ring));
+			return *ring;
+		};
+
+		/// Capture the arguments and queue them, falling back to formatting here when the record will not fit in the ring
+		inline void _push(const int _line_, const char *_file_, const char *fmt, const size_t fmtSize, const bool copyFmt,
+			imp::_Arg *args, const size_t numArgs) {
+
+			std::string &stash = imp::_deferredStash();
+			stash.clear();
+			for (size_t i = 0; i < numArgs; ++i) imp::_captureArg(_line_, _file_, args[i], stash);
+			for (size_t i = 0; i < numArgs; ++i) imp::_resolveStash(args[i], stash);
+
+			imp::_DeferredRing &ring = _ring();
+			if (imp::_pushDeferred(ring, _line_, _file_, fmt, fmtSize, copyFmt, args, numArgs)) {
+				_notify();
+				return;
+			}
+
+			/// Keep this thread's output in order by letting the queue empty first
+			ring.drain();
+			imp::_MemoryBuffer<> ret;
+			imp::_vformat(_line_, _file_, ret, fmt, fmt + fmtSize, args, numArgs);
+			std::lock_guard<std::mutex> lock(_sinkMutex);
+			_sink(ret.data(), ret.size());
+		};
+
+		/// Wake the background thread if it is parked, a record committed before this either is seen by _run or sees the flag
+		inline void _notify() {
+			if (!_sleeping.load(std::memory_order_seq_cst)) return;
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				_sleeping.store(false, std::memory_order_relaxed);
+			}
+			_wake.notify_one();
+		};
+
+		/// Take a new copy of the list of rings if it has changed since version
+		inline void _refresh(std::vector<std::shared_ptr<imp::_DeferredRing>> &rings, size_t &version) {
+			std::lock_guard<std::mutex> lock(_ringsMutex);
+			if (version != _version) {
+				rings = _rings;
+				version = _version;
+			}
+		};
+
+		/// Whether any ring holds records which have not been formatted yet
+		inline bool _pending(std::vector<std::shared_ptr<imp::_DeferredRing>> &rings, size_t &version) {
+			_refresh(rings, version);
+			for (const std::shared_ptr<imp::_DeferredRing> &ring : rings)
+				if (ring->_head.load(std::memory_order_seq_cst) != ring->_read) return true;
+			return false;
+		};
+
+		/**
+		 * Format everything queued in every ring and give it to the sink in one batch
+		 * @return			Returns true if anything was written
+		 */
+		inline bool _drain(std::vector<std::shared_ptr<imp::_DeferredRing>> &rings, size_t &version, std::string &batch) {
+			_refresh(rings, version);
+
+			bool any = false;
+			for (const std::shared_ptr<imp::_DeferredRing> &ring : rings) {
+				const size_t head = ring->_head.load(std::memory_order_acquire);
+				any = any || (ring->_read != head);
+				while (ring->_read != head) {
+					char *rec = ring->data() + (ring->_read & (ring->capacity() - 1u));
+					const imp::_DeferredHeader &header = *reinterpret_cast<const imp::_DeferredHeader*>(rec);
+					if (header.numArgs != (size_t) -1) {
+						imp::_StringBuffer ret(batch);
+						imp::_formatDeferred(ret, rec);
+						ret.flush();
+					}
+					ring->_read += header.size;
+				}
+			}
+			if (!any) return false;
+
+			if (!batch.empty()) {
+				std::lock_guard<std::mutex> lock(_sinkMutex);
+				_sink(batch.data(), batch.size());
+				batch.clear();
+			}
+			for (const std::shared_ptr<imp::_DeferredRing> &ring : rings) ring->_tail.store(ring->_read, std::memory_order_release);
+
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+			}
+			_done.notify_all();
+			return true;
+		};
+
+		/// Release the rings of threads which have exited once they are empty
+		inline void _release() {
+			std::lock_guard<std::mutex> lock(_ringsMutex);
+			const size_t size = _rings.size();
+			_rings.erase(std::remove_if(_rings.begin(), _rings.end(), [](const std::shared_ptr<imp::_DeferredRing> &ring) {
+				return ring->_orphaned.load(std::memory_order_acquire) &&
+					ring->_tail.load(std::memory_order_relaxed) == ring->_head.load(std::memory_order_acquire);
+			}), _rings.end());
+			if (_rings.size() != size) ++_version;
+		};
+
+		/// Background thread, drains the rings until they are empty then parks until a call is queued
+		inline void _run() {
+			std::vector<std::shared_ptr<imp::_DeferredRing>> rings;
+			size_t version = (size_t) -1;
+			std::string batch;
+			while (true) {
+				if (_drain(rings, version, batch)) continue;
+				_release();
+
+				std::unique_lock<std::mutex> lock(_mutex);
+				if (_stop) break;
+				/// Say the thread is parking before looking once more, a caller either sees the flag or its record is seen here
+				_sleeping.store(true, std::memory_order_seq_cst);
+				if (_pending(rings, version)) {
+					_sleeping.store(false, std::memory_order_relaxed);
+					continue;
+				}
+				_wake.wait(lock, [this]() { return _stop || !_sleeping.load(std::memory_order_relaxed); });
+			}
+			/// Anything queued before the destructor was called
+			_drain(rings, version, batch);
+		};
+
+		sink_type _sink;
+		const size_t _ringSize;
+		const size_t _id;
+
+		std::mutex _ringsMutex;
+		std::vector<std::shared_ptr<imp::_DeferredRing>> _rings;
+		size_t _version;
+
+		std::mutex _mutex;
+		std::condition_variable _wake, _done;
+		bool _stop;
+		std::atomic<bool> _sleeping;	/// The background thread is parked on _wake, callers must notify it
+
+		std::mutex _sinkMutex;
+		std::thread _thread;
+	};
+
+#ifdef STR_EXT_CPP17
+	/**
+	 * Lazy range of the pieces of a string between delimiters, created by str::split. Pieces are string_views into the
+	 * original text, which must outlive the range, and are found one at a time as the range is iterated so nothing is allocated.
+	 */
+	class split_range {
+	public:
+		/// Forward iterator over the pieces
+		class iterator {
+		public:
+			typedef std::forward_iterator_tag iterator_category;
+			typedef std::string_view value_type;
+			typedef std::ptrdiff_t difference_type;
+			typedef const std::string_view* pointer;
+			typedef std::string_view reference;
+
+			/// The end iterator
+			iterator() : _range(nullptr), _pos(nullptr), _next(nullptr), _pieces(0u) {};
+
+			inline std::string_view operator*() const { return std::string_view(_pos, (size_t) (_next - _pos)); };
+
+			inline iterator& operator++() {
+				if (_next == _range->_end) _range = nullptr;
+				else _find(_next + 1);
+				return *this;
+			};
+
+			inline iterator operator++(int) {
+				iterator prev = *this;
+				++(*this);
+				return prev;
+			};
+
+			/// Only the end iterator has no range, other iterators are equal when they point at the same piece
+			inline bool operator==(const iterator &other) const {
+				return _range == other._range && (_range == nullptr || _pos == other._pos);
+			};
+			inline bool operator!=(const iterator &other) const { return !(*this == other); };
+
+		private:
+			friend class split_range;
+
+			explicit iterator(const split_range *range) : _range(range), _pos(nullptr), _next(nullptr), _pieces(0u) {
+				_find(range->_begin);
+			};
+
+			/// Find the piece starting at pos, once the limit is reached the rest of the text is the last piece
+			inline void _find(const char *pos) {
+				const split_range &range = *_range;
+				if (_pieces == range._maxSplits) {
+					if (range._skipEmpty) {
+						while (pos != range._end && range._set.contains(*pos)) ++pos;
+						if (pos == range._end) {
+							_range = nullptr;
+							return;
+						}
+					}
+					_pos = pos;
+					_next = range._end;
+					return;
+				}
+
+				const char *next = range._findAny(pos, range._end, range._set);
+				while (range._skipEmpty && next == pos) {
+					if (pos == range._end) {
+						_range = nullptr;
+						return;
+					}
+					next = range._findAny(++pos, range._end, range._set);
+				}
+				_pos = pos;
+				_next = next;
+				++_pieces;
+			};
+
+			const split_range *_range;
+			const char *_pos;		/// Start of the current piece
+			const char *_next;		/// The delimiter ending it, or the end of the text
+			size_t _pieces;			/// Pieces found by searching, not counting a remainder
+		};
+
+		typedef iterator const_iterator;
+
+		/**
+		 * @param text		The text to split, not copied
+		 * @param delims	Each char is a delimiter, up to 8 are searched with SIMD
+		 * @param skipEmpty	Leave out empty pieces, so runs of delimiters count as one
+		 * @param maxSplits	Split at most this many times, the rest of the text is the last piece
+		 */
+		split_range(const std::string_view text, const std::string_view delims, const bool skipEmpty, const size_t maxSplits) :
+			_begin(text.data()), _end(text.data() + text.size()), _skipEmpty(skipEmpty), _maxSplits(maxSplits),
+			_set(delims.data(), delims.size()), _findAny(str::imp::_findAnyKernel(_set)) {};
+
+		inline iterator begin() const { return iterator(this); };
+		inline iterator end() const { return iterator(); };
+
+		/// Copy the pieces out, for when they are needed more than once
+		inline std::vector<std::string_view> to_vector() const { return std::vector<std::string_view>(begin(), end()); };
+
+	private:
+		const char *_begin, *_end;
+		bool _skipEmpty;
+		size_t _maxSplits;
+		str::imp::_DelimSet _set;
+		str::imp::_FindAny _findAny;
+	};
+
+	/**
+	 * Split a string at any of a set of delimiter chars, the pieces are found lazily as string_views into text
+	 * @param text		The text to split, which must outlive the range
+	 * @param delims	Each char is a delimiter, sets of up to 8 chars are searched 16 or 32 bytes at a time
+	 * @param skipEmpty	Leave out empty pieces, so runs of delimiters count as one
+	 * @param maxSplits	Split at most this many times, the rest of the text is the last piece
+	 * @return			Returns a forward range of std::string_view
+	 */
+	inline split_range split(const std::string_view text, const std::string_view delims, const bool skipEmpty = false, const size_t maxSplits = (size_t) -1) {
+		return split_range(text, delims, skipEmpty, maxSplits);
+	};
+
+	/// Split a string at a single delimiter char
+	inline split_range split(const std::string_view text, const char delim, const bool skipEmpty = false, const size_t maxSplits = (size_t) -1) {
+		return split_range(text, std::string_view(&delim, 1u), skipEmpty, maxSplits);
 	};
 
+	/// The range points into text, so a temporary std::string would leave it dangling
+	template<typename S, typename D, typename = typename std::enable_if<std::is_same<S, std::string>::value>::type>
+	split_range split(S &&text, const D &delims, const bool skipEmpty = false, const size_t maxSplits = (size_t) -1) = delete;
+#endif
+
 }; /// str namespace
\ No newline at end of file
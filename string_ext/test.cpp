@@ -22,7 +22,19 @@ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 SOFTWARE.
 */
 
+/// Also build with -DSTR_EXT_C_LOCALE to check the library's own float and long double conversion against printf:
+///		g++ -std=c++11 -O2 -pthread -DSTR_EXT_C_LOCALE test.cpp -o test_c_locale
+
 #include "string_ext.h"
+#include <fstream>
+#include <cfloat>
+
+#ifdef STR_EXT_C_LOCALE
+/// A global locale with a ',' decimal point, which output in STR_EXT_C_LOCALE mode must not pick up
+struct CommaPoint : std::numpunct<char> {
+	char do_decimal_point() const override { return ','; };
+};
+#endif
 
 struct Test {
 	int a;
@@ -35,6 +47,20 @@ struct Test {
 	};
 };
 
+struct Point {
+	int x, y;
+};
+
+/// Specialize str::formatter to write '%s' straight into the output instead of going through ostream<<
+namespace str {
+	template<>
+	struct formatter<Point> {
+		inline void format(str::writer &out, const Point &v) const {
+			out.format("(%d, %d)", v.x, v.y);
+		};
+	};
+};
+
 int main() {
 	Test obj{5, 3.14};
 	
@@ -86,6 +112,12 @@ int main() {
 	/// int - Sign
 	printf("int %+d %+d\n", -1, 2);
 	std::cout << format_str("int %+d %+d\n", -1, 2) << std::endl;
+	/// int - Limits
+	printf("int %lld %llu %#llx %#llo %hd\n", LLONG_MIN, ULLONG_MAX, ULLONG_MAX, ULLONG_MAX, (short) SHRT_MIN);
+	std::cout << format_str("int %d %u %#x %#o %d\n", LLONG_MIN, ULLONG_MAX, ULLONG_MAX, ULLONG_MAX, (short) SHRT_MIN) << std::endl;
+	/// int - Precision / Digit Count
+	printf("int |%.5d|%.0d|%8.3x|%-+12.10d|%d|%d|\n", 42, 0, 7u, 99999, 1000000000, 999999999);
+	std::cout << format_str("int |%.5d|%.0d|%8.3x|%-+12.10d|%d|%d|\n", 42, 0, 7u, 99999, 1000000000, 999999999) << std::endl;
 	/// int - Char Count
 	//int a = 0;
 	//printf("int %n %d\n", &a, a); // Compiler error MSVC'2013, %n deprecated
@@ -159,6 +191,48 @@ int main() {
 	/// float-g - Sign
 	printf("float-g '%+g' '%+g' '%g' '%g'\n", -1.f, 2.f, -1.f, 2.f);
 	std::cout << format_str("float-g '%+g' '%+g' '%g' '%g'\n", -1.f, 2.f, -1.f, 2.f) << std::endl;
+	/// float-g - Rounding carries
+	printf("float-g |%.3g|%#.3g|%g|%#g|%.0g|\n", 999.7, 999.7, 999999.7, 0.00009997, 0.5);
+	std::cout << format_str("float-g |%.3g|%#.3g|%g|%#g|%.0g|\n", 999.7, 999.7, 999999.7, 0.00009997, 0.5) << std::endl;
+
+	/// float - Matches printf byte for byte across magnitudes, precisions, ties and carries
+	const char *floatFmts[] = { "%f", "%.0f", "%.2f", "%#.0f", "%.17f", "%e", "%.0e", "%.3E", "%#.0e", "%.16e", "%.30e",
+		"%g", "%.0g", "%.3g", "%#g", "%#.3g", "%.17g", "%G", "%.40f" };
+	const double floatVals[] = { 0.0, -0.0, 0.5, 1.5, 2.5, 0.125, 0.375, 1e-5, 9.9999995, 999.7, 999999.7, 123456789012345678.0, 
+		1e22, 1e23, 1.7976931348623157e308, 2.2250738585072014e-308, 5e-324, -3.14159265358979, 1.0 / 3.0, 0.1f };
+	int floatMismatches = 0;
+	for (const char *fmt : floatFmts) {
+		for (const double val : floatVals) {
+			char buf[512];
+			std::snprintf(buf, sizeof(buf), fmt, val);
+			if (str::format(fmt, val) != buf) ++floatMismatches;
+		}
+	}
+	printf("float mismatches: 0\n");
+	std::cout << format_str("float mismatches: %d\n", floatMismatches) << std::endl;
+
+	/// long double - The same formats, past the range of double and through the exact conversion under STR_EXT_C_LOCALE
+#ifdef STR_EXT_C_LOCALE
+	const std::locale oldLocale = std::locale::global(std::locale(std::locale::classic(), new CommaPoint()));
+#endif
+	const long double longVals[] = { 0.0L, -0.0L, 0.5L, 2.5L, 1.0L / 3.0L, 0.1L, 1e22L, 1e23L, 123456789012345678901234567890.0L, 
+		1e308L * 10.0L, 1e-320L / 1e20L, -3.14159265358979323846L, LDBL_MAX, LDBL_MIN, LDBL_MIN / 1024.0L, LDBL_EPSILON };
+	int longMismatches = 0;
+	for (const char *fmt : floatFmts) {
+		/// printf needs the 'L' length modifier before the specifier
+		std::string longFmt = fmt;
+		longFmt.insert(longFmt.size() - 1u, 1u, 'L');
+		for (const long double val : longVals) {
+			char buf[8192];
+			std::snprintf(buf, sizeof(buf), longFmt.c_str(), val);
+			if (str::format(fmt, val) != buf) ++longMismatches;
+		}
+	}
+#ifdef STR_EXT_C_LOCALE
+	std::locale::global(oldLocale);
+#endif
+	printf("long double mismatches: 0\n");
+	std::cout << format_str("long double mismatches: %d\n", longMismatches) << std::endl;
 
 	/// string
 	printf("string '%s'\n", "Hello world");
@@ -172,6 +246,13 @@ int main() {
 	/// string - Precision
 	printf("string '%.5s' '%.10s' '%s'\n", "ABCDEFGHIJKLMN", "ABCDEFGHIJKLMN", "ABCDEFGHIJKLMN");
 	std::cout << format_str("string '%.5s' '%.10s' '%s'\n", "ABCDEFGHIJKLMN", "ABCDEFGHIJKLMN", "ABCDEFGHIJKLMN") << std::endl;
+	/// string - std::string and const char* are written without copying
+	const std::string hello = "Hello world";
+	const char *helloPtr = hello.c_str();
+	printf("string '%-12.5s' '%8s' '%.3s'\n", hello.c_str(), helloPtr, helloPtr);
+	std::cout << format_str("string '%-12.5s' '%8s' '%.3s'\n", hello, helloPtr, helloPtr) << std::endl;
+	/// string - str::formatter<T> specialization
+	std::cout << format_str("string '%s' '%12s' '%.4s'\n", Point{1, 2}, Point{3, 4}, Point{5, 6}) << std::endl;
 
 	/// char
 	printf("char '%c' '%c'\n", (unsigned char) '&', '&');
@@ -205,10 +286,191 @@ int main() {
 		  << format_str(rowFmt, c0 - 3, 1, c1 - 3, "Dick",  c2 - 3, 50, c3 - 3, "Ipsum...")
 		  << format_str(rowFmt, c0 - 3, 2, c1 - 3, "Harry", c2 - 3, 20, c3 - 3, "Lorem...");
 
-	//std::cout << format_str("Cause an error: %m", 0);
+	/// compiled - Runtime format string parsed once and typechecked on first use
+	const str::compiled_format compiledRow(__LINE__, __FILE__, rowFmt);
+	std::cout << compiledRow(c0 - 3, 3, c1 - 3, "Tom",   c2 - 3, 99, c3 - 3, "Lorem...")
+		  << compiledRow(c0 - 3, 4, c1 - 3, "Dick",  c2 - 3, 50, c3 - 3, "Ipsum...")
+		  << compiledRow(c0 - 3, 5, c1 - 3, "Harry", c2 - 3, 20, c3 - 3, "Lorem...") << std::endl;
+	/// compiled - Char Count and escaped percent signs
+	const str::compiled_format compiledCount("%%%n|%d|%%\n");
+	int e;
+	std::cout << compiledCount(e, e) << compiledCount(e, 7) << std::endl;
+
+	/// compile-time - Format string parsed and typechecked by the compiler (C++14)
+	printf("literal %d %#x |%8.3f| '%-6s' %%\n", 42, 255u, 3.14159, "abc");
+	std::cout << format_str(fmt_lit("literal %d %#x |%8.3f| '%-6s' %%\n"), 42, 255u, 3.14159, "abc") << std::endl;
+	/// compile-time - Width / Precision arguments
+	printf("literal |%*d|%-*.*f|\n", 6, 7, 10, 2, 1.5);
+	std::cout << str::format(fmt_lit("literal |%*d|%-*.*f|\n"), 6, 7, 10, 2, 1.5) << std::endl;
+	/// compile-time - Char Count
+	int d;
+	std::cout << format_str(fmt_lit("literal: %n%d\n"), d, d) << std::endl;
+#ifdef STR_EXT_CPP14
+	/// compile-time - Integers, chars, bools and char arrays formatted into a fixed size string, by the compiler when constant (C++17)
+	printf("%08x-%s|%+5d|%c|%s\n", 0xBEEF, "key", 42, 'z', "true");
+#ifdef STR_EXT_CPP17
+	constexpr auto key = str::static_format(fmt_lit("%08x-%s|%+5d|%c|%#b\n"), 0xBEEF, "key", 42, 'z', true);
+#else
+	const auto key = str::static_format(fmt_lit("%08x-%s|%+5d|%c|%#b\n"), 0xBEEF, "key", 42, 'z', true);
+#endif
+	std::cout << key << std::endl;
+#endif
+
+	/// vformat - One non-template formatting loop over type erased arguments
+	const std::string name = "vformat";
+	printf("%s %d %.2f %c\n", name.c_str(), 7, 0.5, 'v');
+	std::cout << str::vformat(__LINE__, __FILE__, "%s %d %.2f %c\n", str::make_format_args(name, 7, 0.5, 'v')) << std::endl;
+
+	/// output - Format straight into a caller provided char buffer
+	char out[64];
+	char *outE = str::format_to(out, "to %05d|%-8s|%.2f", 42, obj, 2.5);
+	printf("to %05d|%-8s|%.2f\n", 42, "(10 Test{5, 3.140000})", 2.5);
+	std::cout << std::string(out, outE) << std::endl;
+	/// output - Format into any output iterator
+	std::string outStr;
+	str::format_to(std::back_inserter(outStr), fmt_lit("iterator %x %c\n"), 3054u, 'z');
+	std::cout << outStr << std::endl;
+	/// output - Write at most n chars but report the full size
+	const auto trunc = str::format_to_n(out, 10, "truncated %s %d", std::string(1000, 'a'), 5);
+	std::cout << std::string(out, trunc.out) << " | size: " << trunc.size << std::endl;
+	/// output - Fixed size array, always null terminated and reports truncation
+	char fixed[16];
+	const auto res = str::format_to_array(fixed, "array %d %s", 123456, "never allocates");
+	printf("%s | size: %d truncated: %d\n", "array 123456 ne", 28, 1);
+	std::cout << fixed << " | size: " << res.size << " truncated: " << res.truncated << std::endl;
+	/// output - Count the chars without writing them
+	printf("size: %d\n", snprintf(nullptr, 0, "%+.3e %s %n", 1e10, "abc", &d));
+	std::cout << "size: " << str::formatted_size("%+.3e %s %n", 1e10, "abc", d) << " %n: " << d << std::endl;
+	/// output - Append onto an existing string, %n counts from the start of the appended text
+	std::string line = "appended:";
+	line.reserve(256);
+	for (int i = 0; i < 4; ++i) str::format_append(line, " %d%n", i * 11, d);
+	printf("appended: 0 11 22 33 | %%n: 3\n");
+	std::cout << line << " | %n: " << d << std::endl;
+	/// output - Print straight to a stream, a FILE* or a file descriptor without building a string
+	printf("printed %d %s\n", 1, "stream");
+	str::print(std::cout, "printed %d %s\n", 1, "stream");
+	std::cout.flush();
+	printf("printed %d %s\n", 2, "file");
+	str::print(stdout, "printed %d %s\n", 2, "file");
+	fflush(stdout);
+#ifdef STR_EXT_POSIX
+	printf("printed %d %s\n", 3, "fd");
+	fflush(stdout);
+	str::print(str::fd(1), "printed %d %s\n", 3, "fd");
+#endif
+#ifdef STR_EXT_POSIX
+	/// output - Scatter-gather, long literals are referenced by the iovecs rather than copied
+	const std::string page = "<html><head><title>%s</title></head>\n<body>The literal text around each field is long enough to be referenced</body>%d\n";
+	str::iovec_message msg;
+	msg.format(page, "iovec", 42);
+	printf(page.c_str(), "iovec", 42);
+	printf("iovecs: 3\n");
+	fflush(stdout);
+	writev(1, msg.data(), (int) msg.size());
+	std::cout << "iovecs: " << msg.size() << std::endl;
+#endif
+#ifdef STR_EXT_POSIX
+	/// output - Format straight into a memory mapped file, trimmed to size when closed
+	{
+		str::mapped_file report("mapped.txt");
+		for (int i = 0; i < 3; ++i) mapped_str(report, "mapped %d %.2f\n", i, i * 1.5);
+		report.close();
+	}
+	for (int i = 0; i < 3; ++i) printf("mapped %d %.2f\n", i, i * 1.5);
+	std::ifstream mapped("mapped.txt");
+	std::cout << mapped.rdbuf() << std::endl;
+	std::remove("mapped.txt");
+#endif
+
+	/// binary - Hex and base64 of byte containers, strings and pointer + length
+	const std::vector<unsigned char> payload = { 0xde, 0xad, 0xbe, 0xef, 0x00, 0x42 };
+	for (unsigned char c : payload) printf("%02x", c);
+	printf(" | %#x | 3q2+7wBC\n", 0xdeadbeef);
+	std::cout << format_str("%h | %#.4h | %m\n", payload, payload, payload) << std::endl;
+	std::cout << format_str("%H | %.*h | %m\n", "hash", 2, (const void*) payload.data(), str::bytes(payload.data(), 3)) << std::endl;
+
+	/// rows - One row per element of parallel columns, the format is parsed once
+	const int ids[] = { 1, 2, 3 };
+	const std::vector<double> values = { 0.5, -1.25, 1e3 };
+	const std::vector<std::string> names = { "a", "bb", "ccc" };
+	for (int i = 0; i < 3; ++i) printf("%d,%.3f,%s\n", ids[i], values[i], names[i].c_str());
+	std::cout << str::format_rows("%d,%.3f,%s\n", ids, values, names);
+	/// rows - One record per element of a range formatted across all cores, in order
+	struct Record { int id; double value; std::string name; };
+	const std::vector<Record> records = { { 1, 0.5, "a" }, { 2, -1.25, "bb" }, { 3, 1e3, "ccc" } };
+	for (const Record &r : records) printf("%d,%.3f,%s\n", r.id, r.value, r.name.c_str());
+	std::cout << str::format_parallel("%d,%.3f,%s\n", records.begin(), records.end(), [](const Record &r) {
+		return std::tie(r.id, r.value, r.name);
+	}) << std::endl;
+
+	/// deferred - Arguments are captured by value and formatted on a background thread
+	printf("deferred %s %d %.2f %s\n", "captured", 5, 2.5, "(1, 2)");
+	{
+		str::deferred_formatter log([](const char *data, size_t size) { std::cout.write(data, size); });
+		std::string temp = "captured";
+		deferred_str(log, "deferred %s %d %.2f %s\n", temp, 5, 2.5, Point{1, 2});
+		temp = "changed";
+		log.flush();
+	}
+	std::cout << std::endl;
+
+	/// scan - Reading values back out of text, input errors are returned rather than fatal
+	const char *scanLine = "id=42 ratio=0.375 name=widget flag=true";
+	int scanId = 0;
+	double scanRatio = 0.0;
+	char scanName[16] = {};
+	sscanf(scanLine, "id=%d ratio=%lf name=%15s", &scanId, &scanRatio, scanName);
+	printf("%d %.3f %s %s\n", scanId, scanRatio, scanName, "true");
+	std::string scanText;
+	bool scanFlag = false;
+	const str::scan_result scanned = scan_str(scanLine, "id=%d ratio=%f name=%s flag=%#b", scanId, scanRatio, scanText, scanFlag);
+	std::cout << format_str("%d %.3f %s %#b\n", scanId, scanRatio, scanText, scanFlag);
+	const str::scan_result failed = str::scan("id=forty", "id=%d", scanId);
+	std::cout << format_str("%u %u | %u %s at %u\n", scanned.count, scanned.pos, failed.count, failed.what(), failed.pos) << std::endl;
+
+	/// cat / join - Concatenation with one allocation, every piece is measured before anything is written
+	const std::string catDir = "/var/log";
+	printf("%s/%s-%d.%s %c %.1f %s\n", catDir.c_str(), "app", 7, "txt", '|', 2.5, "true");
+	std::cout << str::cat(catDir, '/', "app", '-', 7, '.', "txt", " | ", 2.5, ' ', true) << std::endl;
+	printf("%d, %d, %d\n", 1, -2, 3);
+	std::cout << str::join(std::vector<int>{ 1, -2, 3 }, ", ") << std::endl << std::endl;
+
+	/// replace_all - Many substitutions in one pass, the longest match wins and replaced text is not matched again
+	const str::replacer greeting({ { "{user}", "ada" }, { "{user_id}", "1815" }, { "{site}", "example.org" } });
+	printf("Hello %s (#%s), welcome to %s\n", "ada", "1815", "example.org");
+	std::cout << greeting("Hello {user} (#{user_id}), welcome to {site}\n");
+	printf("%s\n", "b a");
+	std::cout << str::replace_all("a b", { { "a", "b" }, { "b", "a" } }) << std::endl << std::endl;
+
+	/// case - ASCII only case conversion and case insensitive compare / hash, 16 or 32 bytes at a time
+	printf("%s %s %d %d %d\n", "content-type", "CONTENT-TYPE", 1, 1, 1);
+	const std::string header = "Content-Type";
+	std::cout << format_str("%s %s %b %b %b\n", str::to_lower(header), str::to_upper(header), str::iequals(header, "CONTENT-type"),
+		str::istarts_with(header, "content-"), str::ihash()(header) == str::ihash()("content-TYPE")) << std::endl;
+
+#ifdef STR_EXT_CPP17
+	/// split - Lazy string_views between delimiters, found with SIMD and without allocating
+	const std::string csvLine = "alpha,beta,,gamma;delta";
+	printf("[alpha] [beta] [] [gamma] [delta] \n");
+	for (const std::string_view piece : str::split(csvLine, ",;")) std::cout << '[' << piece << "] ";
+	std::cout << std::endl;
+	printf("[alpha] [beta] [gamma;delta] \n");
+	for (const std::string_view piece : str::split(csvLine, ',', true, 2)) std::cout << '[' << piece << "] ";
+	std::cout << std::endl << std::endl;
+#endif
+
+#ifdef STR_EXT_CPP17
+	/// string_view format - Only the view is read, the chars after it are never parsed
+	const std::string_view cutFmt = std::string_view("view %.3f|%.*dXYZ").substr(0, 10);
+	printf("view %.3f|\n", 2.5);
+	std::cout << format_str(cutFmt, 2.5) << std::endl << std::endl;
+#endif
+
+	//std::cout << format_str("Cause an error: %q", 0);
 	//
 	// Line: 100 File: 'test.cpp'
-	// String Format | Undefined format specifier : 'm'
+	// String Format | Undefined format specifier : 'q'
 
 	//std::cout << format_str("Cause an error: %i", 0.f);
 	//
@@ -265,5 +527,14 @@ int main() {
 	// Line: 125 File: 'test.cpp'
 	// String Format | Format flag already set: 'Force Long'
 
+	//std::cout << format_str(std::string_view("Cause an error: %.*d", 18), 5, 1);
+	//
+	// Line: 130 File: 'test.cpp'
+	// String Format | Incomplete format string: Ended in '.'
+
+	//std::cout << format_str(fmt_lit("Cause an error: %i"), 0.f);
+	//
+	// Fails to compile (C++14): static assertion failed: String Format | Incorrect format specifier for type
+
 	return EXIT_SUCCESS;
 };
\ No newline at end of file